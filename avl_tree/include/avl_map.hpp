@@ -0,0 +1,141 @@
+#pragma once
+
+#include "avl_tree.hpp"
+#include <cstdint>
+#include <utility>
+
+//-----------------------------------------------------------------------------------------
+
+// Key -> value tree. Nodes keep only the key and the index of the value (hot part), the
+// values themselves live in a separate array (cold part), so a search touches the same
+// amount of memory per level as tree_t<key_type>.
+
+namespace avl {
+
+template<typename key_type>
+struct map_key_t {
+    key_type key;
+    uint32_t value_idx = 0;
+
+    friend bool operator< (const map_key_t& lhs, const map_key_t& rhs) {return lhs.key < rhs.key;};
+    friend bool operator> (const map_key_t& lhs, const map_key_t& rhs) {return rhs.key < lhs.key;};
+    friend bool operator==(const map_key_t& lhs, const map_key_t& rhs) {
+        return !(lhs.key < rhs.key) && !(rhs.key < lhs.key);
+    }
+};
+
+template<typename key_type = int, typename value_type = int>
+class map_t final {
+    tree_t<map_key_t<key_type>> tree_;
+    std::vector<value_type>     values_;
+
+    std::pair<uint32_t, bool> insert_key(const key_type& key);
+    template<typename... Args>
+    void emplace_value(const key_type& key, Args&&... args);
+
+    public:
+        map_t(){};
+
+        value_type*       find(const key_type& key);
+        const value_type* find(const key_type& key) const;
+
+        template<typename V>
+        bool insert_or_assign(const key_type& key, V&& value);
+        template<typename... Args>
+        bool try_emplace(const key_type& key, Args&&... args);
+
+        size_t size() const {return tree_.size();};
+        size_t range_query(const key_type& l_bound, const key_type& u_bound) const {
+            return tree_.range_query({l_bound}, {u_bound});
+        }
+        template<typename F>
+        void inorder_walk(const key_type& l_bound, const key_type& u_bound, F func);
+        template<typename F>
+        void inorder_walk(const key_type& l_bound, const key_type& u_bound, F func) const;
+};
+
+//-----------------------------------------------------------------------------------------
+
+template<typename key_type, typename value_type>
+value_type* map_t<key_type, value_type>::find(const key_type& key) {
+    auto node = tree_.find({key});
+    if (!node.is_valid())
+        return nullptr;
+    return &values_[node.get_key().value_idx];
+}
+
+template<typename key_type, typename value_type>
+const value_type* map_t<key_type, value_type>::find(const key_type& key) const {
+    auto node = tree_.find({key});
+    if (!node.is_valid())
+        return nullptr;
+    return &values_[node.get_key().value_idx];
+}
+
+// links key with the index of the next value in one descent, returns the value index of
+// the key and true if the key was not present
+template<typename key_type, typename value_type>
+std::pair<uint32_t, bool> map_t<key_type, value_type>::insert_key(const key_type& key) {
+    if (values_.size() >= UINT32_MAX)
+        throw("Too many values for map_t");
+    uint32_t new_idx = static_cast<uint32_t>(values_.size());
+    auto node = tree_.insert(wrap_node_t<map_key_t<key_type>>{nullptr}, {key, new_idx});
+    uint32_t value_idx = node.get_key().value_idx;
+    return {value_idx, value_idx == new_idx};
+}
+
+// value of the key just linked by insert_key, the key is unlinked if construction throws
+template<typename key_type, typename value_type>
+template<typename... Args>
+void map_t<key_type, value_type>::emplace_value(const key_type& key, Args&&... args) {
+    try {
+        values_.emplace_back(std::forward<Args>(args)...);
+    }
+    catch (...) {
+        tree_.erase({key});
+        throw;
+    }
+}
+
+// returns true if key was inserted, false if the value of present key was replaced
+template<typename key_type, typename value_type>
+template<typename V>
+bool map_t<key_type, value_type>::insert_or_assign(const key_type& key, V&& value) {
+    auto [value_idx, is_inserted] = insert_key(key);
+    if (!is_inserted) {
+        values_[value_idx] = std::forward<V>(value);
+        return false;
+    }
+    emplace_value(key, std::forward<V>(value));
+    return true;
+}
+
+// value is constructed only if key is not present yet
+template<typename key_type, typename value_type>
+template<typename... Args>
+bool map_t<key_type, value_type>::try_emplace(const key_type& key, Args&&... args) {
+    if (!insert_key(key).second)
+        return false;
+    emplace_value(key, std::forward<Args>(args)...);
+    return true;
+}
+
+// calls func(key, value) for keys in [l_bound, u_bound] in sorted order
+template<typename key_type, typename value_type>
+template<typename F>
+void map_t<key_type, value_type>::inorder_walk(const key_type& l_bound, const key_type& u_bound,
+                                               F func) {
+    tree_.inorder_walk({l_bound}, {u_bound}, [&](const map_key_t<key_type>& map_key) {
+        func(map_key.key, values_[map_key.value_idx]);
+    });
+}
+
+template<typename key_type, typename value_type>
+template<typename F>
+void map_t<key_type, value_type>::inorder_walk(const key_type& l_bound, const key_type& u_bound,
+                                               F func) const {
+    tree_.inorder_walk({l_bound}, {u_bound}, [&](const map_key_t<key_type>& map_key) {
+        func(map_key.key, values_[map_key.value_idx]);
+    });
+}
+}
@@ -1,10 +1,17 @@
 #pragma once
 
 #include "utils.hpp"
+#include "node_pool.hpp"
+#include "balance_policy.hpp"
 #include <memory>
 #include <stack>
 #include <cassert>
 #include <utility>
+#include <vector>
+#include <algorithm>
+#include <future>
+#include <thread>
+#include <type_traits>
 
 //-----------------------------------------------------------------------------------------
 
@@ -12,10 +19,14 @@ namespace avl {
 
 template <typename key_type> class node_t;
 
+template<typename key_type, bool is_multi, typename balance_type> class tree_t;
+template<typename key_type> class node_handle_t;
+
 template<typename key_type = int>
 class wrap_node_t final {
 
     node_t<key_type>* dat_node_;
+    template<typename, bool, typename> friend class tree_t;
 
     public:
         wrap_node_t(node_t<key_type>* node) : dat_node_(node) {};
@@ -32,44 +43,101 @@ class wrap_node_t final {
                 return dat_node_->get_size();
             return 0;
         }
+        size_t get_count() const {
+            if (dat_node_)
+                return dat_node_->get_count();
+            return 0;
+        }
         size_t define_node_rank(node_t<key_type>* root) const {
             if (dat_node_)
                 return dat_node_->define_node_rank(root, dat_node_);
             return 0;
         }
-        bool is_valid() {
+        bool is_valid() const {
             return (dat_node_ != nullptr);
         }
 };
 
+// Augmentation of subtrees. A key type may declare augment_type and two functions
+//  static augment_type augment(const key_type& key)
+//  static augment_type combine(const augment_type& left, const augment_type& right)
+// then every node keeps combine over the keys of its subtree in order (e.g. the maximum
+// end of intervals, see interval_tree.hpp). It is recomputed wherever size_ is, so
+// rotations, erase, split and join keep it valid. Other keys take no space for it.
+template<typename key_type, typename = void>
+struct augment_base_t {
+    static constexpr bool is_augmented = false;
+};
+
+template<typename key_type>
+struct augment_base_t<key_type, std::void_t<typename key_type::augment_type>> {
+    static constexpr bool is_augmented = true;
+    typename key_type::augment_type augment_ {};
+};
+
 template <typename key_type = int>
-class node_t {
-    using unique_ptr_node_t = typename std::unique_ptr<node_t<key_type>>;
+class node_t : private augment_base_t<key_type> {
+    public:
+        using unique_ptr_node_t = typename std::unique_ptr<node_t<key_type>,
+                                                           node_deleter_t<node_t<key_type>>>;
+    private:
 
     unique_ptr_node_t left_      = nullptr;
     unique_ptr_node_t right_     = nullptr;
     node_t<key_type>* parent_ = nullptr;
-    size_t size_   = 1;
-    size_t height_ = 1;
+    size_t   size_   = 1; // elements in subtree, equal keys included
+    uint32_t height_ = 1;
+    uint32_t count_  = 1; // copies of key_, more than 1 only in multiset
     key_type key_;
 
+    template<typename> friend class node_handle_t;
     public:
 
-        node_t(const key_type& key) : key_(key){};
-        node_t(key_type&& key) :  key_(std::forward<key_type>(key)) {};
-        node_t(const node_t<key_type>& node) : key_(node.key_),
-                                               height_(node.height_) {
+        node_t(const key_type& key) : key_(key) {change_augment();};
+        template<typename... Args>
+        explicit node_t(std::in_place_t, Args&&... args) :
+            key_(construct_key(std::forward<Args>(args)...)) {change_augment();};
+        node_t(key_type&& key) :  key_(std::forward<key_type>(key)) {change_augment();};
+        node_t(const node_t<key_type>& node) : augment_base_t<key_type>(node),
+                                               size_(node.size_),
+                                               height_(node.height_),
+                                               count_(node.count_),
+                                               key_(node.key_) {
 
             unique_ptr_node_t ret_node = safe_copy(node);
             left_  = std::move(ret_node->left_);
             right_ = std::move(ret_node->right_);
         }
-        node_t(key_type key, size_t size, size_t height) :
-            key_(key),
-            size_(size), height_(height)
-            {};
-
-        unique_ptr_node_t safe_copy (const node_t<key_type>& node);
+        node_t(key_type key, size_t size, size_t height, size_t count = 1) :
+            size_(size), height_(height), count_(count),
+            key_(key)
+            {change_augment();};
+
+        template<typename... Args>
+        static unique_ptr_node_t make_node(Args&&... args);
+
+        static unique_ptr_node_t safe_copy (const node_t<key_type>& node);
+        // has_copies - some node may hold several copies of its key (multiset), then
+        // nodes are counted before the copy since size_ counts copies
+        static unique_ptr_node_t clone(const node_t<key_type>* root,
+                                       size_t n_threads = std::thread::hardware_concurrency(),
+                                       bool has_copies = true);
+    private:
+        // the key is built right in its place: aggregates from braces, others from parentheses
+        template<typename... Args>
+        static key_type construct_key(Args&&... args) {
+            if constexpr (std::is_aggregate_v<key_type>)
+                return key_type{std::forward<Args>(args)...};
+            else
+                return key_type(std::forward<Args>(args)...);
+        }
+        static constexpr size_t clone_parallel_cutoff = 1 << 15; // subtree copied in a thread
+        static size_t count_nodes(const node_t<key_type>* node, std::vector<size_t>& nodes);
+        static node_t<key_type>* clone_subtree(const node_t<key_type>* origine_node,
+                                               char* block, size_t offset,
+                                               node_t<key_type>* parent, size_t n_threads,
+                                               const size_t* nodes);
+    public:
         node_t<key_type>& operator= (const node_t<key_type>& node);
         node_t(node_t<key_type>&& node) = default;
         node_t<key_type>& operator= (node_t<key_type>&& node) = default;
@@ -82,7 +150,10 @@ class node_t {
         }
         unique_ptr_node_t& get_left()  {return left_;};
         unique_ptr_node_t& get_right() {return right_;};
+        const unique_ptr_node_t& get_left()  const {return left_;};
+        const unique_ptr_node_t& get_right() const {return right_;};
         node_t<key_type>* get_parent() {return parent_;};
+        const node_t<key_type>* get_parent() const {return parent_;};
         void set_parent(node_t<key_type>* node) {parent_ = node;};
         void set_left(unique_ptr_node_t& node) {left_ = node;};
         void set_right(unique_ptr_node_t& node) {right_ = node;};
@@ -96,6 +167,12 @@ class node_t {
         key_type const & get_key() const {
             return key_;
         }
+        size_t get_count() const {
+            return count_;
+        }
+        size_t get_size()   const {return size_;};
+        size_t get_height() const {return height_;};
+        void   set_height(size_t height) {height_ = height;};
         void change_height(unique_ptr_node_t& node) {
             if (node) {
                 node->height_ = 1 + std::max(get_height(node->left_),
@@ -106,20 +183,72 @@ class node_t {
         }
         void change_size(unique_ptr_node_t& node) {
             if (node) {
-                node->size_ = 1 + get_size(node->left_) +
-                                  get_size(node->right_);
+                node->size_ = node->count_ + get_size(node->left_) +
+                                             get_size(node->right_);
+                node->change_augment();
             }
         }
 
+        void change_augment() {
+            if constexpr (augment_base_t<key_type>::is_augmented) {
+                auto augment = key_type::augment(key_);
+                if (left_)
+                    augment = key_type::combine(left_->augment_, augment);
+                if (right_)
+                    augment = key_type::combine(augment, right_->augment_);
+                this->augment_ = augment;
+            }
+        }
+        void copy_augment(const node_t<key_type>& node) {
+            if constexpr (augment_base_t<key_type>::is_augmented)
+                this->augment_ = node.augment_;
+        }
+        const auto& get_augment() const {return this->augment_;};
+
         unique_ptr_node_t balance_subtree(unique_ptr_node_t& cur_node, const key_type& key);
+        unique_ptr_node_t rebalance(unique_ptr_node_t& cur_node);
         unique_ptr_node_t rotate_to_left(unique_ptr_node_t& cur_node);
         unique_ptr_node_t rotate_to_right(unique_ptr_node_t& cur_node);
-        unique_ptr_node_t insert(unique_ptr_node_t& cur_node,  const key_type& key);
-        unique_ptr_node_t emplace(unique_ptr_node_t& cur_node, key_type&& key);
+        unique_ptr_node_t insert(unique_ptr_node_t& cur_node,  const key_type& key,
+                                 bool is_multi = false);
+        unique_ptr_node_t emplace(unique_ptr_node_t& cur_node, key_type&& key,
+                                  bool is_multi = false);
+        static unique_ptr_node_t build_sorted(const key_type* keys, const uint32_t* counts,
+                                              size_t num, node_t<key_type>* parent);
+        template<typename K>
+        static node_t<key_type>* finger_search(node_t<key_type>* finger, const K& key);
+        template<typename K>
+        static node_t<key_type>* descend(node_t<key_type>* start, const K& key);
+        template<typename K>
+        static bool is_equal(const node_t<key_type>* node, const K& key) {
+            return !(node->key_ < key) && !(key < node->key_);
+        }
+        template<typename balance_type, typename K>
+        static node_t<key_type>* insert_from(unique_ptr_node_t& root, node_t<key_type>* start,
+                                             K&& key, bool is_multi = false);
+        template<typename balance_type>
+        static node_t<key_type>* link(unique_ptr_node_t& root, node_t<key_type>* parent,
+                                      unique_ptr_node_t&& node);
+        template<typename balance_type>
+        static void add_copies(unique_ptr_node_t& root, node_t<key_type>* node, size_t num);
+        template<typename balance_type>
+        static void remove_copies(unique_ptr_node_t& root, node_t<key_type>* node, size_t num);
+        template<typename balance_type>
+        static void retrace_insert(unique_ptr_node_t& root, node_t<key_type>* node, size_t num);
+
+        template<typename balance_type = balance::avl_t>
+        unique_ptr_node_t extract(unique_ptr_node_t& cur_node, const key_type& key,
+                                  unique_ptr_node_t& extracted);
+        template<typename balance_type = balance::avl_t>
+        unique_ptr_node_t remove_min(unique_ptr_node_t& cur_node);
+        static unique_ptr_node_t join(unique_ptr_node_t& left, unique_ptr_node_t& mid,
+                                      unique_ptr_node_t& right);
+        static unique_ptr_node_t join(unique_ptr_node_t& left, unique_ptr_node_t& right);
+        static void split(unique_ptr_node_t& cur_node, const key_type& key, bool is_key_left,
+                          unique_ptr_node_t& left, unique_ptr_node_t& right);
 
 
         std::vector<key_type> store_inorder_walk() const;
-        void graphviz_dump(graphviz::dump_graph_t& tree_dump) const ;
         node_t<key_type>* upper_bound(avl::node_t<key_type>* node, const key_type& key) const;
         node_t<key_type>* lower_bound(avl::node_t<key_type>* node, const key_type& key) const;
 
@@ -136,14 +265,13 @@ node_t<key_type>& node_t<key_type>::operator= (const node_t<key_type>& node) {
     if (this == &node)
         return *this;
 
-    std::unique_ptr<node_t<key_type>> tmp_left_  =
-                                std::make_unique<node_t<key_type>> (*(node.left_));
-    std::unique_ptr<node_t<key_type>> tmp_right_ =
-                                std::make_unique<node_t<key_type>> (*(node.right_));
+    unique_ptr_node_t tmp_left_  = make_node(*(node.left_));
+    unique_ptr_node_t tmp_right_ = make_node(*(node.right_));
     assert(tmp_left_ != nullptr && tmp_right_ != nullptr);
 
     key_   = node.key_;
     height_= node.height_;
+    copy_augment(node);
 
     left_  = std::move(tmp_left_);
     right_ = std::move(tmp_right_);
@@ -156,25 +284,30 @@ typename node_t<key_type>::unique_ptr_node_t
 node_t<key_type>::safe_copy(const node_t<key_type>& origine_node) {
 
     auto origine_node_ptr = &origine_node;
-    std::unique_ptr<node_t<key_type>> new_node =
-                        std::make_unique<node_t<key_type>>(origine_node_ptr->key_,
-                        origine_node_ptr->size_, origine_node_ptr->height_);
+    unique_ptr_node_t new_node = make_node(origine_node_ptr->key_,
+                        origine_node_ptr->size_, origine_node_ptr->height_,
+                        origine_node_ptr->count_);
+    new_node->copy_augment(origine_node);
 
     node_t<key_type>* iter_node = new_node.get();
     while (origine_node_ptr != nullptr) {
         if (iter_node->left_ == nullptr && origine_node_ptr->left_ != nullptr) {
-            iter_node->left_ = std::make_unique<node_t<key_type>>(
+            iter_node->left_ = make_node(
                             origine_node_ptr->left_->key_,
-                            origine_node_ptr->left_->size_, origine_node_ptr->left_->height_);
+                            origine_node_ptr->left_->size_, origine_node_ptr->left_->height_,
+                            origine_node_ptr->left_->count_);
+            iter_node->left_->copy_augment(*origine_node_ptr->left_);
             iter_node->left_->parent_ = iter_node;
 
             iter_node    = iter_node->left_.get();
             origine_node_ptr = origine_node_ptr->left_.get();
         }
         else if (iter_node->right_ == nullptr && origine_node_ptr->right_ != nullptr) {
-            iter_node->right_ = std::make_unique<node_t<key_type>>(
+            iter_node->right_ = make_node(
                             origine_node_ptr->right_->key_,
-                            origine_node_ptr->right_->size_, origine_node_ptr->right_->height_);
+                            origine_node_ptr->right_->size_, origine_node_ptr->right_->height_,
+                            origine_node_ptr->right_->count_);
+            iter_node->right_->copy_augment(*origine_node_ptr->right_);
             iter_node->right_->parent_ = iter_node;
 
             iter_node    = iter_node->right_.get();
@@ -188,35 +321,130 @@ node_t<key_type>::safe_copy(const node_t<key_type>& origine_node) {
     return new_node;
 }
 
+template<typename key_type>
+template<typename... Args>
+typename node_t<key_type>::unique_ptr_node_t
+node_t<key_type>::make_node(Args&&... args) {
+    void* storage = node_pool_t<node_t<key_type>>::allocate();
+    try {
+        return unique_ptr_node_t(new (storage) node_t<key_type>(std::forward<Args>(args)...));
+    }
+    catch (...) {
+        node_pool_t<node_t<key_type>>::deallocate(storage);
+        throw;
+    }
+}
+
 //-----------------------------------------------------------------------------------------
 
+// Stores node count of every subtree by preorder position of its root, returns the
+// node count of subtree of node.
+template<typename key_type>
+size_t node_t<key_type>::count_nodes(const node_t<key_type>* node, std::vector<size_t>& nodes) {
+    size_t pos = nodes.size();
+    nodes.push_back(1);
+    if (node->left_ != nullptr)
+        nodes[pos] += count_nodes(node->left_.get(), nodes);
+    if (node->right_ != nullptr)
+        nodes[pos] += count_nodes(node->right_.get(), nodes);
+    return nodes[pos];
+}
+
+// Copies subtree of origine_node into block in preorder: node at offset, left subtree
+// right after it, right subtree after the left one. nodes[offset] is the node count of
+// subtree at offset, nullptr if every node holds one copy and size_ is the node count.
+template<typename key_type>
+node_t<key_type>*
+node_t<key_type>::clone_subtree(const node_t<key_type>* origine_node, char* block,
+                                size_t offset, node_t<key_type>* parent, size_t n_threads,
+                                const size_t* nodes) {
+    constexpr size_t slot_size = node_pool_t<node_t<key_type>>::slot_size;
+
+    unique_ptr_node_t new_node(new (block + offset * slot_size) node_t<key_type>(
+                               origine_node->key_, origine_node->size_,
+                               origine_node->height_, origine_node->count_));
+    new_node->copy_augment(*origine_node);
+    new_node->parent_ = parent;
+
+    const node_t<key_type>* origine_left  = origine_node->left_.get();
+    const node_t<key_type>* origine_right = origine_node->right_.get();
+    size_t left_nodes = 0;
+    if (origine_left != nullptr)
+        left_nodes = nodes ? nodes[offset + 1] : origine_left->size_;
+    __builtin_prefetch(origine_right);
+
+    std::future<node_t<key_type>*> left_copy;
+    if (origine_left != nullptr) {
+        if (n_threads > 1 && left_nodes >= clone_parallel_cutoff) {
+            left_copy = std::async(std::launch::async, clone_subtree, origine_left, block,
+                                   offset + 1, new_node.get(), n_threads / 2, nodes);
+            n_threads -= n_threads / 2;
+        }
+        else {
+            new_node->left_.reset(clone_subtree(origine_left, block, offset + 1,
+                                                new_node.get(), 1, nodes));
+        }
+    }
+    if (origine_right != nullptr) {
+        new_node->right_.reset(clone_subtree(origine_right, block, offset + 1 + left_nodes,
+                                             new_node.get(), n_threads, nodes));
+    }
+    if (left_copy.valid())
+        new_node->left_.reset(left_copy.get());
+
+    return new_node.release();
+}
+
+// Copies the whole subtree into one block of nodes, parent links are set on the way.
+// Nodes of the block are released one by one as usual.
 template<typename key_type>
 typename node_t<key_type>::unique_ptr_node_t
-node_t<key_type>::insert(unique_ptr_node_t& cur_node, const key_type& key) {
+node_t<key_type>::clone(const node_t<key_type>* root, size_t n_threads, bool has_copies) {
+    if (root == nullptr)
+        return nullptr;
+
+    std::vector<size_t> nodes;
+    if (has_copies)
+        count_nodes(root, nodes);
+    size_t num_of_nodes = has_copies ? nodes.front() : root->size_;
+
+    char* block = static_cast<char*>(node_pool_t<node_t<key_type>>::allocate_block(num_of_nodes));
+    return unique_ptr_node_t(clone_subtree(root, block, 0, nullptr, std::max<size_t>(1, n_threads),
+                                           has_copies ? nodes.data() : nullptr));
+}
+
+//-----------------------------------------------------------------------------------------
+
+template<typename key_type>
+typename node_t<key_type>::unique_ptr_node_t
+node_t<key_type>::insert(unique_ptr_node_t& cur_node, const key_type& key, bool is_multi) {
     if(!cur_node)
         throw("Invalid ptr");
 
     if (cur_node->key_ < key) {
         if (cur_node->right_ != nullptr) {
-            auto new_node = insert(cur_node->right_, key);
+            auto new_node = insert(cur_node->right_, key, is_multi);
             std::swap(cur_node->right_, new_node); //just for interest
         }
         else {
-            cur_node->right_ = std::make_unique<node_t<key_type>>(key);
+            cur_node->right_ = make_node(key);
             assert(cur_node->right_ != nullptr);
         }
         cur_node->right_->parent_ = cur_node.get();
     }
     else if (cur_node->key_ > key) {
         if (cur_node->left_ != nullptr) {
-            cur_node->left_ = insert(cur_node->left_, key);
+            cur_node->left_ = insert(cur_node->left_, key, is_multi);
         }
         else {
-            cur_node->left_ = std::make_unique<node_t<key_type>>(key);
+            cur_node->left_ = make_node(key);
             assert(cur_node->left_ != nullptr);
         }
         cur_node->left_->parent_ = cur_node.get();
     }
+    else if (is_multi) {
+        ++cur_node->count_;
+    }
 
     change_height(cur_node);
     change_size(cur_node);
@@ -227,29 +455,32 @@ node_t<key_type>::insert(unique_ptr_node_t& cur_node, const key_type& key) {
 
 template<typename key_type>
 typename node_t<key_type>::unique_ptr_node_t
-node_t<key_type>::emplace(unique_ptr_node_t& cur_node, key_type&& key) {
+node_t<key_type>::emplace(unique_ptr_node_t& cur_node, key_type&& key, bool is_multi) {
     if(!cur_node)
         throw("Invalid ptr");
 
     if (cur_node->key_ < key) {
         if (cur_node->right_ != nullptr) {
-            auto new_node = emplace(cur_node->right_, std::forward<key_type>(key));
+            auto new_node = emplace(cur_node->right_, std::forward<key_type>(key), is_multi);
             std::swap(cur_node->right_, new_node);
         }
         else
-            cur_node->right_ = std::make_unique<node_t<key_type>>(std::forward<key_type>(key));
+            cur_node->right_ = make_node(std::forward<key_type>(key));
 
         cur_node->right_->parent_ = cur_node.get();
     }
     else if (cur_node->key_ > key) {
         if (cur_node->left_ != nullptr) {
-            cur_node->left_ = emplace(cur_node->left_, std::forward<key_type>(key));
+            cur_node->left_ = emplace(cur_node->left_, std::forward<key_type>(key), is_multi);
         }
         else
-            cur_node->left_ = std::make_unique<node_t<key_type>>(std::forward<key_type>(key));
+            cur_node->left_ = make_node(std::forward<key_type>(key));
 
         cur_node->left_->parent_ = cur_node.get();
     }
+    else if (is_multi) {
+        ++cur_node->count_;
+    }
 
     change_height(cur_node);
     change_size(cur_node);
@@ -257,6 +488,307 @@ node_t<key_type>::emplace(unique_ptr_node_t& cur_node, key_type&& key) {
     return balance_subtree(cur_node, key);
 }
 
+template<typename key_type>
+typename node_t<key_type>::unique_ptr_node_t
+node_t<key_type>::build_sorted(const key_type* keys, const uint32_t* counts, size_t num,
+                               node_t<key_type>* parent) {
+    if (num == 0)
+        return nullptr;
+
+    size_t mid = num / 2;
+    unique_ptr_node_t cur_node = make_node(keys[mid]);
+    cur_node->parent_ = parent;
+    cur_node->count_  = counts ? counts[mid] : 1;
+    cur_node->left_   = build_sorted(keys, counts, mid, cur_node.get());
+    cur_node->right_  = build_sorted(keys + mid + 1, counts ? counts + mid + 1 : nullptr,
+                                     num - mid - 1, cur_node.get());
+
+    cur_node->change_height(cur_node);
+    cur_node->change_size(cur_node);
+    return cur_node;
+}
+
+//--------------------FINGER--------------------------------------------------------------
+
+// Climbs from finger while key is out of the bounds of the visited subtree. Returns the
+// node to descend from: the last visited node that is between finger and key, or the
+// node with key itself. Costs O(log(d)) where d is the distance between finger and key.
+// K is key_type or any type comparable with it.
+template<typename key_type>
+template<typename K>
+node_t<key_type>*
+node_t<key_type>::finger_search(node_t<key_type>* finger, const K& key) {
+    bool is_right = finger->key_ < key;
+    if (!is_right && !(key < finger->key_))
+        return finger;
+
+    node_t<key_type>* near_node = finger;
+    node_t<key_type>* cur_node  = finger;
+    while (true) {
+        // parents reached from this side are between finger and key as well
+        while (cur_node->parent_ != nullptr &&
+               (is_right ? cur_node->parent_->right_ : cur_node->parent_->left_).get() == cur_node)
+            cur_node = cur_node->parent_;
+
+        node_t<key_type>* parent = cur_node->parent_;
+        if (parent == nullptr || (is_right ? key < parent->key_ : parent->key_ < key))
+            return near_node;
+        if (is_equal(parent, key))
+            return parent;
+        near_node = cur_node = parent;
+    }
+}
+
+// returns the node with key or the node under which key is to be linked
+template<typename key_type>
+template<typename K>
+node_t<key_type>* node_t<key_type>::descend(node_t<key_type>* start, const K& key) {
+    node_t<key_type>* cur_node = start;
+    while (true) {
+        if (cur_node->key_ < key) {
+            if (cur_node->right_ == nullptr)
+                return cur_node;
+            cur_node = cur_node->right_.get();
+        }
+        else if (key < cur_node->key_) {
+            if (cur_node->left_ == nullptr)
+                return cur_node;
+            cur_node = cur_node->left_.get();
+        }
+        else
+            return cur_node;
+    }
+}
+
+// Bottom-up insertion: descends from start (root or result of finger_search) and
+// retraces to the root. Returns the node with key.
+template<typename key_type>
+template<typename balance_type, typename K>
+node_t<key_type>*
+node_t<key_type>::insert_from(unique_ptr_node_t& root, node_t<key_type>* start, K&& key,
+                              bool is_multi) {
+    node_t<key_type>* cur_node = descend(start, key);
+    if (is_equal(cur_node, key)) {
+        if (is_multi)
+            add_copies<balance_type>(root, cur_node, 1);
+        return cur_node;
+    }
+    return link<balance_type>(root, cur_node, make_node(std::forward<K>(key)));
+}
+
+// links detached node (with count_ copies of its key) as a child of parent, returns it
+template<typename key_type>
+template<typename balance_type>
+node_t<key_type>* node_t<key_type>::link(unique_ptr_node_t& root, node_t<key_type>* parent,
+                                         unique_ptr_node_t&& node) {
+    node_t<key_type>* new_node = node.get();
+    new_node->parent_ = parent;
+    if (new_node->key_ < parent->key_)
+        parent->left_  = std::move(node);
+    else
+        parent->right_ = std::move(node);
+
+    retrace_insert<balance_type>(root, parent, new_node->count_);
+    return new_node;
+}
+
+template<typename key_type>
+template<typename balance_type>
+void node_t<key_type>::add_copies(unique_ptr_node_t& root, node_t<key_type>* node, size_t num) {
+    node->count_ += num;
+    retrace_insert<balance_type>(root, node, num);
+}
+
+// num < count_ copies are taken from node, the node itself stays in the tree
+template<typename key_type>
+template<typename balance_type>
+void node_t<key_type>::remove_copies(unique_ptr_node_t& root, node_t<key_type>* node, size_t num) {
+    node->count_ -= num;
+    while (node != nullptr) {
+        node_t<key_type>* parent = node->parent_;
+        node->size_ -= num;
+        node->change_augment();
+        unique_ptr_node_t& owner = (parent == nullptr) ? root :
+                                   (parent->left_.get() == node) ? parent->left_ :
+                                                                   parent->right_;
+        balance_type::fix_after_erase(owner);  // only weight_t may rotate here
+        node = parent;
+    }
+}
+
+// Subtree of node got num more elements: sizes are increased up to the root, balance is
+// fixed by the policy until it reports that ancestors are not affected.
+template<typename key_type>
+template<typename balance_type>
+void node_t<key_type>::retrace_insert(unique_ptr_node_t& root, node_t<key_type>* node,
+                                      size_t num) {
+    bool is_balanced = false;
+    while (node != nullptr) {
+        node_t<key_type>* parent = node->parent_;
+        node->size_ += num;
+        node->change_augment();
+        if (!is_balanced) {
+            unique_ptr_node_t& owner = (parent == nullptr) ? root :
+                                       (parent->left_.get() == node) ? parent->left_ :
+                                                                       parent->right_;
+            is_balanced = balance_type::fix_after_insert(owner);
+        }
+        node = parent;
+    }
+}
+
+//--------------------ERASE----------------------------------------------------------------
+
+// Unlinks the node with key (all its copies) into extracted, the node is left with no
+// children and size_ equal to count_. Returns the new root of subtree.
+template<typename key_type>
+template<typename balance_type>
+typename node_t<key_type>::unique_ptr_node_t
+node_t<key_type>::extract(unique_ptr_node_t& cur_node, const key_type& key,
+                          unique_ptr_node_t& extracted) {
+    if (!cur_node)
+        return nullptr;
+
+    if (cur_node->key_ < key) {
+        cur_node->right_ = extract<balance_type>(cur_node->right_, key, extracted);
+        if (cur_node->right_)
+            cur_node->right_->parent_ = cur_node.get();
+    }
+    else if (key < cur_node->key_) {
+        cur_node->left_ = extract<balance_type>(cur_node->left_, key, extracted);
+        if (cur_node->left_)
+            cur_node->left_->parent_ = cur_node.get();
+    }
+    else {
+        extracted = std::move(cur_node);
+        size_t height = extracted->height_;
+        unique_ptr_node_t left  = std::move(extracted->left_);
+        unique_ptr_node_t right = std::move(extracted->right_);
+        extracted->parent_ = nullptr;
+        extracted->height_ = 1;
+        extracted->size_   = extracted->count_;
+        extracted->change_augment();
+
+        if (left == nullptr)
+            return right;
+        if (right == nullptr)
+            return left;
+
+        cur_node = remove_min<balance_type>(right);
+        cur_node->height_ = height;     // takes the place and the rank of extracted
+        cur_node->left_  = std::move(left);
+        cur_node->right_ = std::move(right);
+        cur_node->left_->parent_ = cur_node.get();
+        if (cur_node->right_)
+            cur_node->right_->parent_ = cur_node.get();
+    }
+
+    change_size(cur_node);
+    balance_type::fix_after_erase(cur_node);
+    return std::move(cur_node);
+}
+
+// detaches the node with minimal key from subtree, the subtree is rebalanced
+template<typename key_type>
+template<typename balance_type>
+typename node_t<key_type>::unique_ptr_node_t
+node_t<key_type>::remove_min(unique_ptr_node_t& cur_node) {
+    if (cur_node->left_ == nullptr) {
+        unique_ptr_node_t min_node = std::move(cur_node);
+        cur_node = std::move(min_node->right_);
+        if (cur_node)
+            cur_node->parent_ = min_node->parent_;
+        min_node->parent_ = nullptr;
+        return min_node;
+    }
+
+    unique_ptr_node_t min_node = remove_min<balance_type>(cur_node->left_);
+    change_size(cur_node);
+    balance_type::fix_after_erase(cur_node);
+    return min_node;
+}
+
+// left < mid < right, mid is a detached node; heights differ by at most 1 + O(log(n))
+// levels are visited
+template<typename key_type>
+typename node_t<key_type>::unique_ptr_node_t
+node_t<key_type>::join(unique_ptr_node_t& left, unique_ptr_node_t& mid,
+                       unique_ptr_node_t& right) {
+    size_t left_height  = mid->get_height(left);
+    size_t right_height = mid->get_height(right);
+
+    if (left_height > right_height + 1) {
+        left->right_ = join(left->right_, mid, right);
+        left->right_->parent_ = left.get();
+        left->change_height(left);
+        left->change_size(left);
+        return left->rebalance(left);
+    }
+    if (right_height > left_height + 1) {
+        right->left_ = join(left, mid, right->left_);
+        right->left_->parent_ = right.get();
+        right->change_height(right);
+        right->change_size(right);
+        return right->rebalance(right);
+    }
+
+    mid->left_  = std::move(left);
+    mid->right_ = std::move(right);
+    if (mid->left_)
+        mid->left_->parent_ = mid.get();
+    if (mid->right_)
+        mid->right_->parent_ = mid.get();
+    mid->change_height(mid);
+    mid->change_size(mid);
+    return std::move(mid);
+}
+
+template<typename key_type>
+typename node_t<key_type>::unique_ptr_node_t
+node_t<key_type>::join(unique_ptr_node_t& left, unique_ptr_node_t& right) {
+    if (!left)
+        return std::move(right);
+    if (!right)
+        return std::move(left);
+
+    unique_ptr_node_t mid = right->remove_min(right);
+    return join(left, mid, right);
+}
+
+// left gets keys less than key (or equal to it if is_key_left), right gets the rest
+template<typename key_type>
+void node_t<key_type>::split(unique_ptr_node_t& cur_node, const key_type& key, bool is_key_left,
+                             unique_ptr_node_t& left, unique_ptr_node_t& right) {
+    if (!cur_node) {
+        left  = nullptr;
+        right = nullptr;
+        return;
+    }
+
+    unique_ptr_node_t cur_left  = std::move(cur_node->left_);
+    unique_ptr_node_t cur_right = std::move(cur_node->right_);
+    if (cur_left)
+        cur_left->parent_ = nullptr;
+    if (cur_right)
+        cur_right->parent_ = nullptr;
+    cur_node->parent_ = nullptr;
+
+    if (cur_node->key_ < key || (is_key_left && !(key < cur_node->key_))) {
+        unique_ptr_node_t sub_left = nullptr;
+        split(cur_right, key, is_key_left, sub_left, right);
+        left = join(cur_left, cur_node, sub_left);
+    }
+    else {
+        unique_ptr_node_t sub_right = nullptr;
+        split(cur_left, key, is_key_left, left, sub_right);
+        right = join(sub_right, cur_node, cur_right);
+    }
+    if (left)
+        left->parent_ = nullptr;
+    if (right)
+        right->parent_ = nullptr;
+}
+
 //----------------------------ROTATES------------------------------------------------------
 
 template<typename key_type>
@@ -289,6 +821,34 @@ node_t<key_type>::balance_subtree(unique_ptr_node_t& cur_node, const key_type& k
         return std::move(cur_node);
 }
 
+// same as balance_subtree, but the kind of rotation is chosen by the balance of the
+// child, so it works after erase, join and split too
+template<typename key_type>
+typename node_t<key_type>::unique_ptr_node_t
+node_t<key_type>::rebalance(unique_ptr_node_t& cur_node) {
+
+    if(!cur_node)
+        throw("Invalid ptr");
+
+    int delta = find_balance_fact(cur_node);
+    if (delta > 1) {
+        if (find_balance_fact(cur_node->right_) < 0) {
+            cur_node->right_ = rotate_to_right(cur_node->right_);
+            cur_node->right_->parent_ = cur_node.get();
+        }
+        return rotate_to_left(cur_node);
+    }
+    else if (delta < -1) {
+        if (find_balance_fact(cur_node->left_) > 0) {
+            cur_node->left_ = rotate_to_left(cur_node->left_);
+            cur_node->left_->parent_ = cur_node.get();
+        }
+        return rotate_to_right(cur_node);
+    }
+    else
+        return std::move(cur_node);
+}
+
 template<typename key_type>
 typename node_t<key_type>::unique_ptr_node_t
 node_t<key_type>::rotate_to_left(unique_ptr_node_t& cur_node) {
@@ -296,7 +856,7 @@ node_t<key_type>::rotate_to_left(unique_ptr_node_t& cur_node) {
     if(!cur_node)
         throw("Invalid ptr");
 
-    std::unique_ptr<node_t<key_type>> root = std::move(cur_node->right_);
+    unique_ptr_node_t root = std::move(cur_node->right_);
     cur_node->right_ = std::move(root->left_);
     if (cur_node->right_) {
         cur_node->right_->parent_ = cur_node.get();
@@ -307,6 +867,7 @@ node_t<key_type>::rotate_to_left(unique_ptr_node_t& cur_node) {
     change_height(root->left_);
     change_height(root);
     root->size_ = root->left_->size_;
+    root->copy_augment(*root->left_);
     change_size(root->left_);
 
     return root;
@@ -330,6 +891,7 @@ node_t<key_type>::rotate_to_right(unique_ptr_node_t& cur_node) {
     change_height(root->right_);
     change_height(root);
     root->size_ = root->right_->size_;
+    root->copy_augment(*root->right_);
     change_size(root->right_);
 
     return root;
@@ -400,14 +962,14 @@ size_t node_t<key_type>::define_node_rank(const node_t<key_type>* root,
     if(cur_node == nullptr)
         throw("Invalid ptr");
 
-    size_t rank = 1;
+    size_t rank = cur_node->count_; // rank of the last copy of the key
     if (cur_node->left_ != nullptr) {
         rank += cur_node->left_->size_;
     }
     const node_t<key_type>* tmp_node = this;
     while (tmp_node != root) {
         if (tmp_node == tmp_node->parent_->right_.get()) {
-            rank += get_size (tmp_node->parent_->left_) + 1;
+            rank += get_size (tmp_node->parent_->left_) + tmp_node->parent_->count_;
         }
         tmp_node = tmp_node->parent_;
         // std::cout << "rank: " << rank << "\n";
@@ -426,7 +988,7 @@ std::vector<key_type> node_t<key_type>::store_inorder_walk() const {
     while (cur_node || !node_stk.empty()) {
         if (!node_stk.empty()) {
             cur_node = node_stk.top();
-            storage.push_back(cur_node->key_);
+            storage.insert(storage.end(), cur_node->count_, cur_node->key_);
             if (cur_node->right_)
                 cur_node = cur_node->right_.get();
             else
@@ -443,24 +1005,5 @@ std::vector<key_type> node_t<key_type>::store_inorder_walk() const {
     return storage;
 }
 
-template<typename key_type>
-void node_t<key_type>::graphviz_dump(graphviz::dump_graph_t& tree_dump) const {
-    tree_dump.graph_node.print_node(this, tree_dump.graphviz_strm);
-
-    if (left_ != nullptr)
-    {
-        tree_dump.graph_edge.fillcolor = "#7FC7FF";
-        tree_dump.graph_edge.color     = "#7FC7FF";
-        tree_dump.graph_edge.print_edge(this, left_, tree_dump.graphviz_strm);
-        left_->graphviz_dump(tree_dump);
-    }
-    if (right_ != nullptr)
-    {
-        tree_dump.graph_edge.fillcolor = "#DC143C";
-        tree_dump.graph_edge.color     = "#DC143C";
-        tree_dump.graph_edge.print_edge(this, right_, tree_dump.graphviz_strm);
-        right_->graphviz_dump(tree_dump);
-    }
-}
 }
 
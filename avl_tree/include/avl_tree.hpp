@@ -1,58 +1,155 @@
 #pragma once
 #include "avl_node.hpp"
+#include "graphviz.h"
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <random>
 
 //-----------------------------------------------------------------------------------------
 
 namespace avl {
 
-template< typename key_type = int>
-class tree_t final {
-    using unique_ptr_node_t = typename std::unique_ptr<node_t<key_type>>;
+// Node taken out of a tree by extract(). It is put into another tree by
+// insert(node_handle_t&&) without allocation; in multiset it keeps all copies of the key.
+template<typename key_type = int>
+class node_handle_t final {
+    using unique_ptr_node_t = typename node_t<key_type>::unique_ptr_node_t;
+
+    unique_ptr_node_t node_ = nullptr;
+
+    template<typename, bool, typename> friend class tree_t;
+    explicit node_handle_t(unique_ptr_node_t&& node) : node_(std::move(node)) {};
+    void make_single() {node_->count_ = 1; node_->size_ = 1;};
+    public:
+        node_handle_t(){};
+
+        bool empty() const {return node_ == nullptr;};
+        explicit operator bool() const {return node_ != nullptr;};
+        // key may be changed before the node is inserted again
+        key_type&       key()       {return node_->key_;};
+        const key_type& key() const {return node_->key_;};
+        size_t count() const {return node_ ? node_->count_ : 0;};
+};
+
+//-----------------------------------------------------------------------------------------
+
+// What graphviz_dump expands. A subtree deeper than max_depth, lying outside
+// [l_bound, u_bound] or left out by sampling is drawn as one box with its size.
+template<typename key_type = int>
+struct dump_config_t {
+    size_t max_depth = std::numeric_limits<size_t>::max();
+    std::optional<key_type> l_bound;
+    std::optional<key_type> u_bound;
+    double   sample = 1.0;  // probability to expand a child subtree
+    unsigned seed   = 0;
+};
 
-    unique_ptr_node_t root_ = nullptr;
+//-----------------------------------------------------------------------------------------
+
+// is_multi - multiset mode: equal keys are kept as a counter in one node and every
+// query counts them as separate elements
+// balance_type - balancing policy from balance_policy.hpp: balance::avl_t,
+// balance::wavl_t or balance::weight_t
+template< typename key_type = int, bool is_multi = false,
+          typename balance_type = balance::avl_t>
+class tree_t final {
+    using unique_ptr_node_t = typename node_t<key_type>::unique_ptr_node_t;
+
+    unique_ptr_node_t root_   = nullptr;
+    node_t<key_type>* finger_ = nullptr; // node of the last insertion, next one starts here
+    uint32_t finger_misses_   = 0;       // finger searches in a row that gave little
+    uint32_t finger_skips_    = 0;
+
+    // after max_finger_misses misses insertions start from the root and the finger is
+    // only retried every finger_probe_period insertion, so random keys do not pay for it
+    static constexpr uint32_t max_finger_misses   = 4;
+    static constexpr uint32_t finger_probe_period = 16;
+    template<typename K>
+    node_t<key_type>* find_start(const K& key);
+
+    // batched queries run batch_group descents in lock-step and prefetch the next node of
+    // each one, so their cache misses overlap instead of following one another
+    static constexpr size_t batch_group = 16;
+    template<typename Step>
+    void descend_batch(size_t num, Step step) const;
     public:
+        using balance_policy = balance_type;
+        static constexpr bool is_multiset = is_multi;
+
         tree_t(){};
         ~tree_t();
         tree_t(const key_type& key) {
-            root_ = std::make_unique<node_t<key_type>>(key);
+            root_ = node_t<key_type>::make_node(key);
             assert(root_ != nullptr);
         };
-        tree_t(const tree_t<key_type>& tree) {
-
-            root_ = std::make_unique<node_t<key_type>>(*(tree.root_));
-            unique_ptr_node_t& root_left  = root_->get_left();
-            unique_ptr_node_t& root_right = root_->get_right();
-            if (root_left != nullptr)
-                root_left->set_parent(root_.get());
-            if (root_right != nullptr)
-                root_right->set_parent(root_.get());
-        };
-        tree_t(tree_t<key_type>&& tree) = default;
+        tree_t(const tree_t<key_type, is_multi, balance_type>& tree) :
+            root_(node_t<key_type>::clone(tree.root_.get(), std::thread::hardware_concurrency(),
+                                          is_multi)) {};
+        tree_t(tree_t<key_type, is_multi, balance_type>&& tree) :
+            root_(std::move(tree.root_)),
+            finger_(std::exchange(tree.finger_, nullptr)),
+            finger_misses_(tree.finger_misses_),
+            finger_skips_(tree.finger_skips_) {};
+
+        tree_t<key_type, is_multi, balance_type>& operator= (tree_t<key_type, is_multi, balance_type>&& tree) {
+            root_   = std::move(tree.root_);
+            finger_ = std::exchange(tree.finger_, nullptr);
+            return *this;
+        }
+        tree_t<key_type, is_multi, balance_type>& operator= (const tree_t<key_type, is_multi, balance_type>& tree);
 
-        tree_t<key_type>& operator= (tree_t<key_type>&& tree) = default;
-        tree_t<key_type>& operator= (const tree_t<key_type>& tree);
+        static tree_t<key_type, is_multi, balance_type> build_sorted(const std::vector<key_type>& keys);
 
         void   insert(const key_type& key);
+        wrap_node_t<key_type> insert(const wrap_node_t<key_type>& hint, const key_type& key);
+        bool   insert(node_handle_t<key_type>&& node);
         template<typename... Args>
 
         void   emplace(Args&&... args);
-        size_t range_query(const int l_bound, const int u_bound) const;
+        template<typename K, typename... Args>
+        bool   try_emplace(const K& key, Args&&... args);
+        node_handle_t<key_type> extract(const key_type& key);
+        size_t erase(const key_type& key);
+        size_t erase_one(const key_type& key);
+        size_t erase(const key_type& l_bound, const key_type& u_bound);
+        size_t range_query(const key_type& l_bound, const key_type& u_bound) const;
         size_t distance(const wrap_node_t<key_type>& l_node, const wrap_node_t<key_type>& u_node) const;
         wrap_node_t<key_type> upper_bound(const key_type& key) const;
         wrap_node_t<key_type> lower_bound(const key_type& key) const;
+        wrap_node_t<key_type> find(const key_type& key) const;
+        size_t rank(const key_type& key) const;
+        size_t count(const key_type& key) const;
+        wrap_node_t<key_type> select(size_t idx) const;
+
+        std::vector<wrap_node_t<key_type>> lower_bound_batch(const std::vector<key_type>& keys) const;
+        std::vector<wrap_node_t<key_type>> upper_bound_batch(const std::vector<key_type>& keys) const;
+        std::vector<size_t> range_query_batch(
+            const std::vector<std::pair<key_type, key_type>>& bounds) const;
+
         std::vector<key_type> store_inorder_walk() const;
-        void graphviz_dump() const;
+        template<typename F>
+        void inorder_walk(const key_type& l_bound, const key_type& u_bound, F func) const;
+        void graphviz_dump(std::ostream& strm, const dump_config_t<key_type>& config = {}) const;
+        void graphviz_dump(const std::string& path, const dump_config_t<key_type>& config = {}) const;
+        void graphviz_dump() const {graphviz_dump("../graph_lib/tree_dump.dot");};
+
+        const node_t<key_type>* get_root() const {return root_.get();};
+        size_t size() const {return root_ ? root_->get_size(root_) : 0;};
 };
 
+template<typename key_type = int, typename balance_type = balance::avl_t>
+using multiset_t = tree_t<key_type, true, balance_type>;
+
 //-----------------------------------------------------------------------------------------
 
-template< typename key_type>
-tree_t<key_type>::~tree_t<key_type> () {
+template< typename key_type, bool is_multi, typename balance_type>
+tree_t<key_type, is_multi, balance_type>::~tree_t () {
 
     if (root_ == nullptr) return;
-    std::stack<std::unique_ptr<node_t<key_type>>> nodes;
+    std::stack<unique_ptr_node_t> nodes;
     nodes.push(std::move(root_));
-    std::unique_ptr<node_t<key_type>> front = nullptr;
+    unique_ptr_node_t front = nullptr;
 
     while(!nodes.empty()) {
         front = std::move(nodes.top());
@@ -71,108 +168,546 @@ tree_t<key_type>::~tree_t<key_type> () {
 
 //-----------------------------------------------------------------------------------------
 
-template< typename key_type>
-tree_t<key_type>& tree_t<key_type>::operator= (const tree_t<key_type>& tree) {
+template< typename key_type, bool is_multi, typename balance_type>
+tree_t<key_type, is_multi, balance_type>& tree_t<key_type, is_multi, balance_type>::operator= (const tree_t<key_type, is_multi, balance_type>& tree) {
     if (this == &tree)
         return *this;
 
-    std::unique_ptr<node_t<key_type>> tmp_root_ =
-                                    std::make_unique<node_t<key_type>>(*(tree.root_));
-    assert(tmp_root_ == nullptr);
-    root_ = std::move(tmp_root_);
+    tree_t<key_type, is_multi, balance_type> tmp_tree {tree};
+    std::swap(root_, tmp_tree.root_);
+    finger_ = nullptr;
 
     return *this;
 }
 
 //-----------------------------------------------------------------------------------------
 
-template< typename key_type>
-void tree_t<key_type>::insert(const key_type& key) {
+// keys must be sorted (and unique for a set), the tree is built in O(n) without rotations
+template< typename key_type, bool is_multi, typename balance_type>
+tree_t<key_type, is_multi, balance_type>
+tree_t<key_type, is_multi, balance_type>::build_sorted(const std::vector<key_type>& keys) {
+    tree_t<key_type, is_multi, balance_type> tree;
+    if constexpr (is_multi) {
+        assert(std::is_sorted(keys.begin(), keys.end()));
+        std::vector<key_type> unique_keys;
+        std::vector<uint32_t> counts;
+        for (const auto& key : keys) {
+            if (unique_keys.empty() || unique_keys.back() < key) {
+                unique_keys.push_back(key);
+                counts.push_back(1);
+            }
+            else
+                ++counts.back();
+        }
+        tree.root_ = node_t<key_type>::build_sorted(unique_keys.data(), counts.data(),
+                                                    unique_keys.size(), nullptr);
+    }
+    else {
+        assert(std::adjacent_find(keys.begin(), keys.end(),
+                                 [](const key_type& x, const key_type& y) {
+                                     return !(x < y);
+                                 }) == keys.end());
+        tree.root_ = node_t<key_type>::build_sorted(keys.data(), nullptr,
+                                                    keys.size(), nullptr);
+    }
+    return tree;
+}
+
+// starts from the node of the previous insertion, so sorted and nearly sorted keys are
+// inserted without descent from the root
+template< typename key_type, bool is_multi, typename balance_type>
+void tree_t<key_type, is_multi, balance_type>::insert(const key_type& key) {
     if (root_ == nullptr) {
-        std::unique_ptr<node_t<key_type>> tmp_root_ =
-                                        std::make_unique<node_t<key_type>>(key);
+        unique_ptr_node_t tmp_root_ = node_t<key_type>::make_node(key);
         assert(tmp_root_ != nullptr);
-        root_ = std::move(tmp_root_);
+        root_   = std::move(tmp_root_);
+        finger_ = root_.get();
+        return;
     }
-    // std::cout << "Here\n" << key << std::endl;
-    root_ = root_->insert(root_, key);
-    // std::cout << "out   \n" << std::endl;
+    finger_ = node_t<key_type>::template insert_from<balance_type>(root_, find_start(key), key, is_multi);
+}
+
+// key is searched from hint (any node of the tree, the closer to key the better) or, if
+// hint is not valid, from the last insertion as in insert(key), returns node with key
+template< typename key_type, bool is_multi, typename balance_type>
+wrap_node_t<key_type>
+tree_t<key_type, is_multi, balance_type>::insert(const wrap_node_t<key_type>& hint, const key_type& key) {
+    if (root_ == nullptr) {
+        insert(key);
+        return finger_;
+    }
+    node_t<key_type>* start = hint.is_valid() ?
+                              node_t<key_type>::finger_search(hint.dat_node_, key) : find_start(key);
+    finger_ = node_t<key_type>::template insert_from<balance_type>(root_, start, key, is_multi);
+    return finger_;
+}
 
-    root_->set_parent(nullptr);
+// the finger is a miss if it does not save at least 3/4 of the descent from the root:
+// climbing back and forth costs more per level than a well predicted descent
+template< typename key_type, bool is_multi, typename balance_type>
+template<typename K>
+node_t<key_type>* tree_t<key_type, is_multi, balance_type>::find_start(const K& key) {
+    if (finger_ == nullptr)
+        return root_.get();
+    if (finger_misses_ >= max_finger_misses && ++finger_skips_ % finger_probe_period != 0)
+        return root_.get();
+
+    node_t<key_type>* start = node_t<key_type>::finger_search(finger_, key);
+    if (4 * start->get_height() > root_->get_height())
+        ++finger_misses_;
+    else
+        finger_misses_ = 0;
+    return start;
 }
 
-template< typename key_type>
+template< typename key_type, bool is_multi, typename balance_type>
 template<typename... Args>
-void tree_t<key_type>::emplace(Args&&... args) {
+void tree_t<key_type, is_multi, balance_type>::emplace(Args&&... args) {
 
-    key_type key = {std::move(args)...};
+    key_type key = {std::forward<Args>(args)...};
     if (root_ == nullptr) {
-        std::unique_ptr<node_t<key_type>> tmp_root_ =
-                         std::make_unique<node_t<key_type>>(std::forward<key_type>(key));
+        unique_ptr_node_t tmp_root_ =
+                         node_t<key_type>::make_node(std::forward<key_type>(key));
         assert(tmp_root_ != nullptr);
-        root_ = std::move(tmp_root_);
+        root_   = std::move(tmp_root_);
+        finger_ = root_.get();
+        return;
+    }
+    node_t<key_type>* start = find_start(key);
+    finger_ = node_t<key_type>::template insert_from<balance_type>(root_, start, std::move(key), is_multi);
+}
+
+// Searches with key (key_type or a type comparable with it) and constructs the element
+// from args (from key if there are no args) only if key is not in the tree. In multiset
+// a present key just gets one more copy. Returns true if an element was added.
+// The element built from args must compare equal to key: it is linked where key belongs.
+template< typename key_type, bool is_multi, typename balance_type>
+template<typename K, typename... Args>
+bool tree_t<key_type, is_multi, balance_type>::try_emplace(const K& key, Args&&... args) {
+    auto make_node = [&]() {
+        if constexpr (sizeof...(Args) == 0)
+            return node_t<key_type>::make_node(std::in_place, key);
+        else
+            return node_t<key_type>::make_node(std::in_place, std::forward<Args>(args)...);
+    };
+    if (root_ == nullptr) {
+        root_   = make_node();
+        finger_ = root_.get();
+        return true;
+    }
+
+    node_t<key_type>* node = node_t<key_type>::descend(find_start(key), key);
+    if (node_t<key_type>::is_equal(node, key)) {
+        finger_ = node;
+        if (!is_multi)
+            return false;
+        node_t<key_type>::template add_copies<balance_type>(root_, node, 1);
+        return true;
+    }
+    unique_ptr_node_t new_node = make_node();
+    assert(node_t<key_type>::is_equal(new_node.get(), key));
+    finger_ = node_t<key_type>::template link<balance_type>(root_, node, std::move(new_node));
+    return true;
+}
+
+// links extracted node, no allocation is done. If key is already in the set the node
+// stays in the handle and false is returned, in multiset copies are added to the
+// present node and the handle is emptied.
+template< typename key_type, bool is_multi, typename balance_type>
+bool tree_t<key_type, is_multi, balance_type>::insert(node_handle_t<key_type>&& node) {
+    if (node.empty())
+        return false;
+    if (!is_multi)
+        node.make_single();
+    node.node_->change_augment();   // the key may have been changed in the handle
+
+    if (root_ == nullptr) {
+        root_   = std::move(node.node_);
+        finger_ = root_.get();
+        return true;
+    }
+
+    node_t<key_type>* parent = node_t<key_type>::descend(find_start(node.key()), node.key());
+    if (node_t<key_type>::is_equal(parent, node.key())) {
+        finger_ = parent;
+        if (!is_multi)
+            return false;
+        node_t<key_type>::template add_copies<balance_type>(root_, parent, node.count());
+        node.node_.reset();
+        return true;
+    }
+    finger_ = node_t<key_type>::template link<balance_type>(root_, parent, std::move(node.node_));
+    return true;
+}
+
+//-----------------------------------------------------------------------------------------
+
+// unlinks the node with key, the handle is empty if there is no such key
+template< typename key_type, bool is_multi, typename balance_type>
+node_handle_t<key_type> tree_t<key_type, is_multi, balance_type>::extract(const key_type& key) {
+    if (root_ == nullptr)
+        return {};
+
+    unique_ptr_node_t extracted = nullptr;
+    finger_ = nullptr;
+    root_ = root_->template extract<balance_type>(root_, key, extracted);
+    if (root_ != nullptr)
+        root_->set_parent(nullptr);
+    return node_handle_t<key_type>(std::move(extracted));
+}
+
+// returns number of erased elements, freed nodes go back to the node pool
+template< typename key_type, bool is_multi, typename balance_type>
+size_t tree_t<key_type, is_multi, balance_type>::erase(const key_type& key) {
+    return extract(key).count();
+}
+
+// erases one copy of key (in multiset the others stay), returns 1 if key was present
+template< typename key_type, bool is_multi, typename balance_type>
+size_t tree_t<key_type, is_multi, balance_type>::erase_one(const key_type& key) {
+    node_t<key_type>* node = find(key).dat_node_;
+    if (node == nullptr)
+        return 0;
+    if (node->get_count() == 1)
+        return extract(key).count();
+
+    node_t<key_type>::template remove_copies<balance_type>(root_, node, 1);
+    return 1;
+}
+
+// erases elements in [l_bound, u_bound] with two splits and one join,
+// O(log(n) + k) where k is number of erased nodes. Policies without join erase the
+// keys one by one, O(k * log(n)).
+template< typename key_type, bool is_multi, typename balance_type>
+size_t tree_t<key_type, is_multi, balance_type>::erase(const key_type& l_bound, const key_type& u_bound) {
+    if (root_ == nullptr || u_bound < l_bound)
+        return 0;
+
+    if constexpr (!balance_type::has_join) {
+        std::vector<key_type> keys;
+        inorder_walk(l_bound, u_bound, [&keys](const key_type& key) {
+            if (keys.empty() || keys.back() < key)
+                keys.push_back(key);
+        });
+        size_t num_of_erased = 0;
+        for (const auto& key : keys)
+            num_of_erased += extract(key).count();
+        return num_of_erased;
     }
-    root_ = root_->emplace(root_, std::forward<key_type>(key));
 
-    root_->set_parent(nullptr);
+    unique_ptr_node_t left   = nullptr;
+    unique_ptr_node_t rest   = nullptr;
+    unique_ptr_node_t middle = nullptr;
+    unique_ptr_node_t right  = nullptr;
+    finger_ = nullptr;
+    node_t<key_type>::split(root_, l_bound, false, left, rest);
+    node_t<key_type>::split(rest, u_bound, true, middle, right);
+
+    size_t num_of_erased = middle ? middle->get_size(middle) : 0;
+    root_ = node_t<key_type>::join(left, right);
+    if (root_ != nullptr)
+        root_->set_parent(nullptr);
+    return num_of_erased;
 }
 
 //-----------------------------------------------------------------------------------------
 
-template< typename key_type>
-wrap_node_t<key_type> tree_t<key_type>::upper_bound(const key_type& key) const {
+template< typename key_type, bool is_multi, typename balance_type>
+wrap_node_t<key_type> tree_t<key_type, is_multi, balance_type>::upper_bound(const key_type& key) const {
     node_t<key_type>* node = root_->upper_bound(root_.get(), key);
     assert(node != nullptr);
     return wrap_node_t{node};
 }
 
-template< typename key_type>
-wrap_node_t<key_type>  tree_t<key_type>::lower_bound(const key_type& key) const {
+template< typename key_type, bool is_multi, typename balance_type>
+wrap_node_t<key_type>  tree_t<key_type, is_multi, balance_type>::lower_bound(const key_type& key) const {
     node_t<key_type>*  node = root_->lower_bound(root_.get(), key);
     assert(node != nullptr);
     return wrap_node_t{node};
 }
 
-template< typename key_type>
-size_t tree_t<key_type>::range_query(const int l_bound, const int u_bound) const {
+template< typename key_type, bool is_multi, typename balance_type>
+size_t tree_t<key_type, is_multi, balance_type>::range_query(const key_type& l_bound, const key_type& u_bound) const {
 
-    if (l_bound >= u_bound || root_ == nullptr) {
+    if (!(l_bound < u_bound) || root_ == nullptr) {
         return 0;
     }
     auto l_node = upper_bound(u_bound);
     auto u_node = lower_bound(l_bound);
     // assert(l_node != nullptr && u_node != nullptr);
 
-    if (u_node.get_key() > u_bound || l_node.get_key() < l_bound) { //corner_case
+    if (u_bound < u_node.get_key() || l_node.get_key() < l_bound) { //corner_case
         return 0;
     }
     return distance(l_node, u_node);
 }
 
-template< typename key_type>
-size_t tree_t<key_type>::distance(const wrap_node_t<key_type>& l_node,
+template< typename key_type, bool is_multi, typename balance_type>
+size_t tree_t<key_type, is_multi, balance_type>::distance(const wrap_node_t<key_type>& l_node,
                                     const wrap_node_t<key_type>& u_node) const {
-    assert(l_node != nullptr && u_node != nullptr);
+    assert(l_node.is_valid() && u_node.is_valid());
     size_t u_bound_rank = l_node.define_node_rank(root_.get());
-    size_t l_bound_rank = u_node.define_node_rank(root_.get());
-    return u_bound_rank - l_bound_rank + 1;
+    size_t l_bound_rank = u_node.define_node_rank(root_.get()) - u_node.get_count();
+    return u_bound_rank - l_bound_rank;
+}
+
+template< typename key_type, bool is_multi, typename balance_type>
+wrap_node_t<key_type> tree_t<key_type, is_multi, balance_type>::find(const key_type& key) const {
+    node_t<key_type>* cur_node = root_.get();
+    while (cur_node != nullptr) {
+        if (cur_node->get_key() < key)
+            cur_node = cur_node->get_right().get();
+        else if (key < cur_node->get_key())
+            cur_node = cur_node->get_left().get();
+        else
+            break;
+    }
+    return wrap_node_t<key_type>{cur_node};
+}
+
+// number of elements less than key
+template< typename key_type, bool is_multi, typename balance_type>
+size_t tree_t<key_type, is_multi, balance_type>::rank(const key_type& key) const {
+    size_t rank = 0;
+    const node_t<key_type>* cur_node = root_.get();
+    while (cur_node != nullptr) {
+        if (cur_node->get_key() < key) {
+            rank += cur_node->get_size(cur_node->get_left()) + cur_node->get_count();
+            cur_node = cur_node->get_right().get();
+        }
+        else
+            cur_node = cur_node->get_left().get();
+    }
+    return rank;
+}
+
+template< typename key_type, bool is_multi, typename balance_type>
+size_t tree_t<key_type, is_multi, balance_type>::count(const key_type& key) const {
+    return find(key).get_count();
+}
+
+// node of the element with index idx (from 0) in sorted order
+template< typename key_type, bool is_multi, typename balance_type>
+wrap_node_t<key_type> tree_t<key_type, is_multi, balance_type>::select(size_t idx) const {
+    node_t<key_type>* cur_node = root_.get();
+    while (cur_node != nullptr) {
+        size_t left_size = cur_node->get_size(cur_node->get_left());
+        if (idx < left_size) {
+            cur_node = cur_node->get_left().get();
+        }
+        else if (idx < left_size + cur_node->get_count()) {
+            return wrap_node_t{cur_node};
+        }
+        else {
+            idx -= left_size + cur_node->get_count();
+            cur_node = cur_node->get_right().get();
+        }
+    }
+    return wrap_node_t<key_type>{nullptr};
 }
 
 //-----------------------------------------------------------------------------------------
 
-template< typename key_type>
-std::vector<key_type> tree_t<key_type>::store_inorder_walk() const {
+// step(idx, node) makes one level of descent number idx from node and returns the next
+// node, nullptr when the descent is over
+template< typename key_type, bool is_multi, typename balance_type>
+template<typename Step>
+void tree_t<key_type, is_multi, balance_type>::descend_batch(size_t num, Step step) const {
+    const node_t<key_type>* nodes[batch_group];
+    for (size_t first = 0; first < num; first += batch_group) {
+        size_t group = std::min(batch_group, num - first);
+        std::fill(nodes, nodes + group, root_.get());
+
+        for (size_t active = group; active > 0;) {
+            active = 0;
+            for (size_t idx = 0; idx < group; ++idx) {
+                if (nodes[idx] == nullptr)
+                    continue;
+                nodes[idx] = step(first + idx, nodes[idx]);
+                if (nodes[idx] != nullptr) {
+                    __builtin_prefetch(nodes[idx]);
+                    ++active;
+                }
+            }
+        }
+    }
+}
+
+// same results as lower_bound for every key: the smallest key >= key, else the maximum
+template< typename key_type, bool is_multi, typename balance_type>
+std::vector<wrap_node_t<key_type>>
+tree_t<key_type, is_multi, balance_type>::lower_bound_batch(const std::vector<key_type>& keys) const {
+    std::vector<wrap_node_t<key_type>> result(keys.size(), wrap_node_t<key_type>{nullptr});
+    std::vector<node_t<key_type>*> last(keys.size());
+    descend_batch(keys.size(), [&](size_t idx, const node_t<key_type>* cur_node) {
+        node_t<key_type>* node = const_cast<node_t<key_type>*>(cur_node);
+        last[idx] = node;
+        if (cur_node->get_key() < keys[idx])
+            return cur_node->get_right().get();
+        result[idx] = wrap_node_t{node};
+        if (keys[idx] < cur_node->get_key())
+            return cur_node->get_left().get();
+        return static_cast<node_t<key_type>*>(nullptr);
+    });
+    for (size_t idx = 0; idx < keys.size(); ++idx)
+        if (!result[idx].is_valid())
+            result[idx] = wrap_node_t{last[idx]};
+    return result;
+}
+
+// same results as upper_bound for every key: the largest key <= key, else the minimum
+template< typename key_type, bool is_multi, typename balance_type>
+std::vector<wrap_node_t<key_type>>
+tree_t<key_type, is_multi, balance_type>::upper_bound_batch(const std::vector<key_type>& keys) const {
+    std::vector<wrap_node_t<key_type>> result(keys.size(), wrap_node_t<key_type>{nullptr});
+    std::vector<node_t<key_type>*> last(keys.size());
+    descend_batch(keys.size(), [&](size_t idx, const node_t<key_type>* cur_node) {
+        node_t<key_type>* node = const_cast<node_t<key_type>*>(cur_node);
+        last[idx] = node;
+        if (keys[idx] < cur_node->get_key())
+            return cur_node->get_left().get();
+        result[idx] = wrap_node_t{node};
+        if (cur_node->get_key() < keys[idx])
+            return cur_node->get_right().get();
+        return static_cast<node_t<key_type>*>(nullptr);
+    });
+    for (size_t idx = 0; idx < keys.size(); ++idx)
+        if (!result[idx].is_valid())
+            result[idx] = wrap_node_t{last[idx]};
+    return result;
+}
+
+// range_query for every pair of bounds: a query is two rank descents, the number of
+// elements < l_bound and the number of elements <= u_bound
+template< typename key_type, bool is_multi, typename balance_type>
+std::vector<size_t> tree_t<key_type, is_multi, balance_type>::range_query_batch(
+    const std::vector<std::pair<key_type, key_type>>& bounds) const {
+
+    std::vector<size_t> ranks(2 * bounds.size(), 0);
+    descend_batch(ranks.size(), [&](size_t idx, const node_t<key_type>* cur_node) {
+        bool is_upper = idx & 1;
+        const key_type& key = is_upper ? bounds[idx / 2].second : bounds[idx / 2].first;
+        bool go_right = is_upper ? !(key < cur_node->get_key()) : cur_node->get_key() < key;
+        if (!go_right)
+            return cur_node->get_left().get();
+        ranks[idx] += cur_node->get_size(cur_node->get_left()) + cur_node->get_count();
+        return cur_node->get_right().get();
+    });
+
+    std::vector<size_t> result(bounds.size(), 0);
+    for (size_t idx = 0; idx < bounds.size(); ++idx)
+        if (bounds[idx].first < bounds[idx].second)
+            result[idx] = ranks[2 * idx + 1] - ranks[2 * idx];
+    return result;
+}
+
+//-----------------------------------------------------------------------------------------
+
+template< typename key_type, bool is_multi, typename balance_type>
+std::vector<key_type> tree_t<key_type, is_multi, balance_type>::store_inorder_walk() const {
     if (root_ == nullptr) {
         return std::vector<key_type> {};
     }
     return root_->store_inorder_walk();
 }
 
-template< typename key_type>
-void tree_t<key_type>::graphviz_dump() const {
-    graphviz::dump_graph_t tree_dump("../graph_lib/tree_dump.dot"); //make boost::program_options
+// calls func for every element in [l_bound, u_bound] in sorted order, O(log(n) + k)
+template< typename key_type, bool is_multi, typename balance_type>
+template<typename F>
+void tree_t<key_type, is_multi, balance_type>::inorder_walk(const key_type& l_bound, const key_type& u_bound,
+                                              F func) const {
+    std::stack<const node_t<key_type>*> node_stk;
+    const node_t<key_type>* cur_node = root_.get();
+
+    while (cur_node || !node_stk.empty()) {
+        while (cur_node) {
+            if (cur_node->get_key() < l_bound) {
+                cur_node = cur_node->get_right().get();
+            }
+            else {
+                node_stk.push(cur_node);
+                cur_node = cur_node->get_left().get();
+            }
+        }
+        if (node_stk.empty())
+            break;
+
+        cur_node = node_stk.top();
+        node_stk.pop();
+        if (u_bound < cur_node->get_key())
+            break;
+        for (size_t copy = 0; copy < cur_node->get_count(); ++copy)
+            func(cur_node->get_key());
+        cur_node = cur_node->get_right().get();
+    }
+}
+
+// iterative dump in dot format, node attributes are written once as graph defaults
+template< typename key_type, bool is_multi, typename balance_type>
+void tree_t<key_type, is_multi, balance_type>::graphviz_dump(std::ostream& strm,
+                                                             const dump_config_t<key_type>& config) const {
+    graphviz::node_t graph_node;
+    graphviz::edge_t graph_edge;
+    strm << "digraph\n{\n";
+    graph_node.print_defaults(strm);
+    graph_edge.print_defaults(strm);
+
+    // keys of a subtree lie between the keys of its nearest left and right ancestors
+    struct frame_t {
+        const node_t<key_type>* node;
+        size_t depth;
+        const key_type* lower;
+        const key_type* upper;
+    };
+    auto is_outside = [&](const frame_t& frame) {
+        return (config.l_bound && frame.upper && !(*config.l_bound < *frame.upper)) ||
+               (config.u_bound && frame.lower && !(*frame.lower < *config.u_bound));
+    };
+    std::mt19937 gen(config.seed);
+    std::bernoulli_distribution is_sampled(std::clamp(config.sample, 0.0, 1.0));
+
+    std::vector<frame_t> frames;
+    if (root_ != nullptr)
+        frames.push_back({root_.get(), 0, nullptr, nullptr});
+    while (!frames.empty()) {
+        frame_t frame = frames.back();
+        frames.pop_back();
+        const node_t<key_type>* node = frame.node;
+
+        bool is_collapsed = frame.depth > config.max_depth || is_outside(frame) ||
+                            (frame.depth > 0 && config.sample < 1.0 && !is_sampled(gen));
+        if (is_collapsed) {
+            strm << "node" << node << " [shape = \"box\", style = \"filled,dashed\", "
+                 << "label = \"subtree\\nsize: " << node->get_size() << "\"]\n";
+            continue;
+        }
+        strm << "node" << node << " [label = \"{key: " << node->get_key()
+             << "| size: " << node->get_size() << "| height: " << node->get_height() << "}\"]\n";
+
+        const node_t<key_type>* right = node->get_right().get();
+        const node_t<key_type>* left  = node->get_left().get();
+        if (right != nullptr) {
+            strm << "node" << node << " -> node" << right << " [color = \"#DC143C\"]\n";
+            frames.push_back({right, frame.depth + 1, &node->get_key(), frame.upper});
+        }
+        if (left != nullptr) {
+            strm << "node" << node << " -> node" << left << " [color = \"#7FC7FF\"]\n";
+            frames.push_back({left, frame.depth + 1, frame.lower, &node->get_key()});
+        }
+    }
+    strm << "}\n";
+}
 
-    root_->graphviz_dump(tree_dump);
-    tree_dump.close_input();
+template< typename key_type, bool is_multi, typename balance_type>
+void tree_t<key_type, is_multi, balance_type>::graphviz_dump(const std::string& path,
+                                                             const dump_config_t<key_type>& config) const {
+    std::vector<char> buffer(1 << 20);
+    std::ofstream strm;
+    strm.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+    strm.open(path);
+    if (!strm.good())
+        throw("Can not open dump file");
+    graphviz_dump(strm, config);
+    strm.close();
 }
 }
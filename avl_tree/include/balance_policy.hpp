@@ -0,0 +1,225 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//-----------------------------------------------------------------------------------------
+
+// Balancing policies of tree_t. A policy keeps its balance information in height_ of the
+// nodes and provides two local fixes, both take the owner of a subtree root and may
+// replace it with a rotated subtree (the new root keeps the parent link of the old one):
+//
+//  bool fix_after_insert(unique_ptr_node_t& node) - a subtree of node has grown, returns
+//       true if ancestors of node need no more balancing (only their sizes)
+//  void fix_after_erase(unique_ptr_node_t& node)  - a subtree of node has shrunk, size_ of
+//       node is already valid
+//
+// has_join tells that heights are exact AVL heights, so split and join can be used for
+// range erase.
+
+namespace avl {
+namespace balance {
+
+inline thread_local size_t num_of_rotations = 0; // for benchmarks
+
+template<typename unique_ptr_node_t>
+void rotate_left(unique_ptr_node_t& node) {
+    auto parent = node->get_parent();
+    node = node->rotate_to_left(node);
+    node->set_parent(parent);
+    ++num_of_rotations;
+}
+
+template<typename unique_ptr_node_t>
+void rotate_right(unique_ptr_node_t& node) {
+    auto parent = node->get_parent();
+    node = node->rotate_to_right(node);
+    node->set_parent(parent);
+    ++num_of_rotations;
+}
+
+template<typename unique_ptr_node_t>
+size_t height(const unique_ptr_node_t& node) {
+    return node ? node->get_height() : 0;
+}
+
+template<typename unique_ptr_node_t>
+size_t weight(const unique_ptr_node_t& node) {
+    return node ? node->get_size() + 1 : 1;
+}
+
+//-----------------------------------------------------------------------------------------
+
+// Classic AVL: height_ is the height, children heights differ by at most 1.
+struct avl_t {
+    static constexpr bool has_join = true;
+
+    template<typename unique_ptr_node_t>
+    static void rebalance(unique_ptr_node_t& node) {
+        int delta = int(height(node->get_right())) - int(height(node->get_left()));
+        if (delta > 1) {
+            auto& right = node->get_right();
+            if (height(right->get_right()) < height(right->get_left()))
+                rotate_right(right);
+            rotate_left(node);
+        }
+        else if (delta < -1) {
+            auto& left = node->get_left();
+            if (height(left->get_left()) < height(left->get_right()))
+                rotate_left(left);
+            rotate_right(node);
+        }
+    }
+
+    template<typename unique_ptr_node_t>
+    static bool fix_after_insert(unique_ptr_node_t& node) {
+        size_t old_height = node->get_height();
+        node->change_height(node);
+        int delta = int(height(node->get_right())) - int(height(node->get_left()));
+        if (delta > 1 || delta < -1) {
+            rebalance(node);
+            return true;
+        }
+        return node->get_height() == old_height;
+    }
+
+    template<typename unique_ptr_node_t>
+    static void fix_after_erase(unique_ptr_node_t& node) {
+        node->change_height(node);
+        rebalance(node);
+    }
+};
+
+//-----------------------------------------------------------------------------------------
+
+// Weak AVL (rank-balanced): height_ is the rank, a missing node has rank 0, a leaf has
+// rank 1 and the rank difference between a node and its child is 1 or 2. Insertion does
+// at most two rotations, erase at most three and rebalancing work is amortised O(1).
+struct wavl_t {
+    static constexpr bool has_join = false;
+
+    template<typename unique_ptr_node_t>
+    static size_t rank(const unique_ptr_node_t& node) {return height(node);};
+
+    template<typename unique_ptr_node_t>
+    static bool fix_after_insert(unique_ptr_node_t& node) {
+        size_t node_rank = node->get_height();
+        bool is_left_grown = (rank(node->get_left()) == node_rank);
+        if (!is_left_grown && rank(node->get_right()) != node_rank)
+            return true;
+        auto& grown   = is_left_grown ? node->get_left()  : node->get_right();
+        auto& sibling = is_left_grown ? node->get_right() : node->get_left();
+
+        if (node_rank - rank(sibling) == 1) {  // 0,1 node: promote and go up
+            node->set_height(node_rank + 1);
+            return false;
+        }
+
+        // 0,2 node: the inner child of grown decides between single and double rotation
+        auto& inner = is_left_grown ? grown->get_right() : grown->get_left();
+        if (!inner || grown->get_height() - inner->get_height() == 2) {
+            auto* old_root = node.get();
+            is_left_grown ? rotate_right(node) : rotate_left(node);
+            node->set_height(node_rank);
+            old_root->set_height(node_rank - 1);
+        }
+        else {
+            auto* old_root  = node.get();
+            auto* old_grown = grown.get();
+            is_left_grown ? rotate_left(grown) : rotate_right(grown);
+            is_left_grown ? rotate_right(node) : rotate_left(node);
+            node->set_height(node_rank);
+            old_grown->set_height(node_rank - 1);
+            old_root->set_height(node_rank - 1);
+        }
+        return true;
+    }
+
+    template<typename unique_ptr_node_t>
+    static void fix_after_erase(unique_ptr_node_t& node) {
+        size_t node_rank = node->get_height();
+        if (!node->get_left() && !node->get_right()) {  // 2,2 leaf
+            node->set_height(1);
+            return;
+        }
+        bool is_left_short = (node_rank - rank(node->get_left()) == 3);
+        if (!is_left_short && node_rank - rank(node->get_right()) != 3)
+            return;
+        auto& sibling = is_left_short ? node->get_right() : node->get_left();
+
+        if (node_rank - sibling->get_height() == 2) {
+            node->set_height(node_rank - 1);
+            return;
+        }
+        auto& outer = is_left_short ? sibling->get_right() : sibling->get_left();
+        auto& inner = is_left_short ? sibling->get_left()  : sibling->get_right();
+        size_t sibling_rank = sibling->get_height();
+        if (sibling_rank - rank(outer) == 2 && sibling_rank - rank(inner) == 2) {
+            node->set_height(node_rank - 1);
+            sibling->set_height(sibling_rank - 1);
+            return;
+        }
+
+        auto* old_root = node.get();
+        if (sibling_rank - rank(outer) == 1) {
+            is_left_short ? rotate_left(node) : rotate_right(node);
+            node->set_height(node_rank);
+            bool is_leaf = !old_root->get_left() && !old_root->get_right();
+            old_root->set_height(is_leaf ? 1 : node_rank - 1);
+        }
+        else {
+            auto* old_sibling = sibling.get();
+            is_left_short ? rotate_right(sibling) : rotate_left(sibling);
+            is_left_short ? rotate_left(node) : rotate_right(node);
+            node->set_height(node_rank);
+            old_sibling->set_height(sibling_rank - 1);
+            old_root->set_height(node_rank - 2);
+        }
+    }
+};
+
+//-----------------------------------------------------------------------------------------
+
+// Weight-balanced tree BB[alpha] with the parameters <3, 2> of Hirai and Yamamoto: weight
+// of a subtree is size_ + 1, the weight of a child is at most delta times the weight of
+// its sibling. Heights are kept exact, but only for information. In multiset the weight
+// counts copies of keys too, so the bound holds only while the counts are small.
+struct weight_t {
+    static constexpr bool has_join = false;
+    static constexpr size_t delta = 3;
+    static constexpr size_t gamma = 2;
+
+    template<typename unique_ptr_node_t>
+    static void rebalance(unique_ptr_node_t& node) {
+        size_t left_weight  = weight(node->get_left());
+        size_t right_weight = weight(node->get_right());
+        if (delta * left_weight < right_weight) {
+            auto& right = node->get_right();
+            if (weight(right->get_left()) >= gamma * weight(right->get_right()))
+                rotate_right(right);
+            rotate_left(node);
+        }
+        else if (delta * right_weight < left_weight) {
+            auto& left = node->get_left();
+            if (weight(left->get_right()) >= gamma * weight(left->get_left()))
+                rotate_left(left);
+            rotate_right(node);
+        }
+    }
+
+    template<typename unique_ptr_node_t>
+    static bool fix_after_insert(unique_ptr_node_t& node) {
+        node->change_height(node);
+        rebalance(node);
+        return false;
+    }
+
+    template<typename unique_ptr_node_t>
+    static void fix_after_erase(unique_ptr_node_t& node) {
+        node->change_height(node);
+        rebalance(node);
+    }
+};
+
+}
+}
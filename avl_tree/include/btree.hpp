@@ -0,0 +1,478 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//-----------------------------------------------------------------------------------------
+
+// B+-tree with the query interface of tree_t for big key sets. Keys are kept only in
+// leaves, leaves are linked in key order. Inner nodes keep separators (the first key
+// under every child but the first one) and the number of keys under every child, so
+// rank and range_query cost O(log_B(n)) and one level costs a few adjacent cache lines
+// instead of a cache miss per binary node.
+//
+// Differences from tree_t: keys are unique, there is no erase, lower_bound / upper_bound
+// return a pointer to the key (nullptr if there is none) like image::view_t does.
+
+namespace avl {
+
+namespace btree {
+constexpr size_t node_bytes = 512; // approximate size of a node, 8 cache lines
+}
+
+template<typename key_type = int>
+class btree_t final {
+    static_assert(std::is_default_constructible_v<key_type>, "keys are kept in arrays");
+
+    struct node_base_t {
+        uint32_t num     = 0;    // keys in leaf, children in inner node
+        bool     is_leaf = true;
+    };
+
+    static constexpr size_t leaf_capacity =
+        std::max<size_t>(4, (btree::node_bytes - sizeof(node_base_t) - 2 * sizeof(void*)) /
+                            sizeof(key_type));
+    static constexpr size_t inner_capacity =
+        std::max<size_t>(4, btree::node_bytes /
+                            (sizeof(key_type) + sizeof(size_t) + sizeof(void*)));
+
+    struct leaf_t : node_base_t {
+        leaf_t*  prev = nullptr;
+        leaf_t*  next = nullptr;
+        key_type keys[leaf_capacity];
+    };
+
+    struct inner_t : node_base_t {
+        inner_t() {this->is_leaf = false;};
+        key_type     keys[inner_capacity - 1]; // keys[i] - the first key under children[i + 1]
+        size_t       counts[inner_capacity];   // number of keys under children[i]
+        node_base_t* children[inner_capacity];
+    };
+
+    // new right sibling made by a split, its first key and number of keys under it
+    struct split_t {
+        node_base_t* node  = nullptr;
+        key_type     key   = {};
+        size_t       count = 0;
+    };
+
+    node_base_t* root_       = nullptr;
+    leaf_t*      first_leaf_ = nullptr;
+    size_t       size_       = 0;
+    size_t       height_     = 0;
+
+    template<typename K>
+    bool insert_into(node_base_t* node, K&& key, split_t& split);
+    template<typename K>
+    bool insert_into_leaf(leaf_t* leaf, K&& key, split_t& split);
+    static void insert_child(inner_t* inner, size_t pos, const split_t& child);
+
+    static size_t child_idx(const inner_t* inner, const key_type& key) { // separators <= key
+        return std::upper_bound(inner->keys, inner->keys + inner->num - 1, key) - inner->keys;
+    }
+    const leaf_t* find_leaf(const key_type& key) const;
+
+    static void destroy(node_base_t* node);
+    static node_base_t* copy(const node_base_t* node, std::vector<leaf_t*>& leaves);
+
+    public:
+        btree_t(){};
+        ~btree_t() {destroy(root_);};
+        btree_t(const btree_t<key_type>& tree);
+        btree_t(btree_t<key_type>&& tree) :
+            root_      (std::exchange(tree.root_, nullptr)),
+            first_leaf_(std::exchange(tree.first_leaf_, nullptr)),
+            size_      (std::exchange(tree.size_, 0)),
+            height_    (std::exchange(tree.height_, 0)) {};
+
+        btree_t<key_type>& operator= (const btree_t<key_type>& tree);
+        btree_t<key_type>& operator= (btree_t<key_type>&& tree);
+
+        bool insert(const key_type& key) {return insert_key(key);};
+        template<typename... Args>
+        bool emplace(Args&&... args) {
+            return insert_key(key_type{std::forward<Args>(args)...});
+        }
+        template<typename K>
+        bool insert_key(K&& key);
+
+        size_t rank(const key_type& key) const;       // number of keys <  key
+        size_t rank_upper(const key_type& key) const; // number of keys <= key
+        size_t count(const key_type& key) const {return rank_upper(key) - rank(key);};
+        size_t range_query(const key_type& l_bound, const key_type& u_bound) const;
+
+        const key_type* find(const key_type& key) const;
+        const key_type* lower_bound(const key_type& key) const; // smallest key >= key
+        const key_type* upper_bound(const key_type& key) const; // largest key  <= key
+        const key_type* select(size_t idx) const;                // idx-th key, from 0
+
+        template<typename F>
+        void inorder_walk(const key_type& l_bound, const key_type& u_bound, F func) const;
+        std::vector<key_type> store_inorder_walk() const;
+
+        size_t size()   const {return size_;};
+        size_t height() const {return height_;};
+};
+
+//-----------------------------------------------------------------------------------------
+
+template<typename key_type>
+void btree_t<key_type>::destroy(node_base_t* node) {
+    if (node == nullptr)
+        return;
+    if (node->is_leaf) {
+        delete static_cast<leaf_t*>(node);
+        return;
+    }
+    inner_t* inner = static_cast<inner_t*>(node);
+    for (size_t idx = 0; idx < inner->num; ++idx)
+        destroy(inner->children[idx]);
+    delete inner;
+}
+
+// copies subtree, leaves are collected in key order to be linked by the caller
+template<typename key_type>
+typename btree_t<key_type>::node_base_t*
+btree_t<key_type>::copy(const node_base_t* node, std::vector<leaf_t*>& leaves) {
+    if (node->is_leaf) {
+        const leaf_t* leaf = static_cast<const leaf_t*>(node);
+        leaf_t* new_leaf = new leaf_t;
+        new_leaf->num = leaf->num;
+        std::copy(leaf->keys, leaf->keys + leaf->num, new_leaf->keys);
+        leaves.push_back(new_leaf);
+        return new_leaf;
+    }
+
+    const inner_t* inner = static_cast<const inner_t*>(node);
+    inner_t* new_inner = new inner_t;
+    try {
+        for (; new_inner->num < inner->num; ++new_inner->num) {
+            size_t idx = new_inner->num;
+            new_inner->children[idx] = copy(inner->children[idx], leaves);
+            new_inner->counts[idx]   = inner->counts[idx];
+        }
+        std::copy(inner->keys, inner->keys + inner->num - 1, new_inner->keys);
+    }
+    catch (...) {
+        destroy(new_inner);
+        throw;
+    }
+    return new_inner;
+}
+
+template<typename key_type>
+btree_t<key_type>::btree_t(const btree_t<key_type>& tree) :
+    size_(tree.size_),
+    height_(tree.height_) {
+
+    if (tree.root_ == nullptr)
+        return;
+    std::vector<leaf_t*> leaves;
+    root_ = copy(tree.root_, leaves);
+    for (size_t idx = 1; idx < leaves.size(); ++idx) {
+        leaves[idx - 1]->next = leaves[idx];
+        leaves[idx]->prev     = leaves[idx - 1];
+    }
+    first_leaf_ = leaves.front();
+}
+
+template<typename key_type>
+btree_t<key_type>& btree_t<key_type>::operator= (const btree_t<key_type>& tree) {
+    if (this == &tree)
+        return *this;
+    btree_t<key_type> tmp_tree {tree};
+    return *this = std::move(tmp_tree);
+}
+
+template<typename key_type>
+btree_t<key_type>& btree_t<key_type>::operator= (btree_t<key_type>&& tree) {
+    std::swap(root_,       tree.root_);
+    std::swap(first_leaf_, tree.first_leaf_);
+    std::swap(size_,       tree.size_);
+    std::swap(height_,     tree.height_);
+    return *this;
+}
+
+//-----------------------------------------------------------------------------------------
+
+// returns true if key was inserted, false if it is already present
+template<typename key_type>
+template<typename K>
+bool btree_t<key_type>::insert_key(K&& key) {
+    if (root_ == nullptr) {
+        leaf_t* leaf = new leaf_t;
+        leaf->keys[0] = std::forward<K>(key);
+        leaf->num     = 1;
+        root_ = first_leaf_ = leaf;
+        size_   = 1;
+        height_ = 1;
+        return true;
+    }
+
+    split_t split;
+    if (!insert_into(root_, std::forward<K>(key), split))
+        return false;
+    ++size_;
+
+    if (split.node != nullptr) {
+        inner_t* new_root = new inner_t;
+        new_root->children[0] = root_;
+        new_root->counts[0]   = size_ - split.count;
+        new_root->num         = 1;
+        insert_child(new_root, 1, split);
+        root_ = new_root;
+        ++height_;
+    }
+    return true;
+}
+
+template<typename key_type>
+template<typename K>
+bool btree_t<key_type>::insert_into(node_base_t* node, K&& key, split_t& split) {
+    if (node->is_leaf)
+        return insert_into_leaf(static_cast<leaf_t*>(node), std::forward<K>(key), split);
+
+    inner_t* inner = static_cast<inner_t*>(node);
+    size_t idx = child_idx(inner, key);
+    split_t child_split;
+    if (!insert_into(inner->children[idx], std::forward<K>(key), child_split))
+        return false;
+
+    ++inner->counts[idx];
+    if (child_split.node == nullptr)
+        return true;
+    inner->counts[idx] -= child_split.count;
+
+    if (inner->num < inner_capacity) {
+        insert_child(inner, idx + 1, child_split);
+        return true;
+    }
+
+    // full node: right half goes to a new sibling; a child appended after the last one
+    // gets the new sibling alone, so sorted input leaves full nodes behind
+    size_t half = (idx + 1 == inner_capacity) ? inner_capacity : inner_capacity / 2;
+    inner_t* right = new inner_t;
+    right->num = inner_capacity - half;
+    std::move(inner->children + half, inner->children + inner_capacity, right->children);
+    std::copy(inner->counts + half, inner->counts + inner_capacity, right->counts);
+    if (half < inner_capacity) {
+        std::move(inner->keys + half, inner->keys + inner_capacity - 1, right->keys);
+        split.key = std::move(inner->keys[half - 1]);
+    }
+    inner->num = half;
+
+    if (idx + 1 <= half && half < inner_capacity) {
+        insert_child(inner, idx + 1, child_split);
+    }
+    else if (half == inner_capacity) {
+        right->children[0] = child_split.node;
+        right->counts[0]   = child_split.count;
+        right->num         = 1;
+        split.key = child_split.key;
+    }
+    else {
+        insert_child(right, idx + 1 - half, child_split);
+    }
+
+    split.node  = right;
+    split.count = 0;
+    for (size_t i = 0; i < right->num; ++i)
+        split.count += right->counts[i];
+    return true;
+}
+
+template<typename key_type>
+template<typename K>
+bool btree_t<key_type>::insert_into_leaf(leaf_t* leaf, K&& key, split_t& split) {
+    size_t pos = std::lower_bound(leaf->keys, leaf->keys + leaf->num, key) - leaf->keys;
+    if (pos < leaf->num && !(key < leaf->keys[pos]))
+        return false;
+
+    if (leaf->num == leaf_capacity) {
+        // append to the last leaf starts a new leaf, otherwise the leaf is split in halves
+        size_t half = (pos == leaf_capacity && leaf->next == nullptr) ? leaf_capacity :
+                                                                        leaf_capacity / 2;
+        leaf_t* right = new leaf_t;
+        right->num = leaf_capacity - half;
+        std::move(leaf->keys + half, leaf->keys + leaf_capacity, right->keys);
+        leaf->num = half;
+
+        right->next = leaf->next;
+        right->prev = leaf;
+        if (right->next != nullptr)
+            right->next->prev = right;
+        leaf->next = right;
+
+        split.node = right;
+        if (pos > half || (pos == half && half == leaf_capacity)) {
+            pos -= half;
+            leaf = right;
+        }
+    }
+
+    std::move_backward(leaf->keys + pos, leaf->keys + leaf->num, leaf->keys + leaf->num + 1);
+    leaf->keys[pos] = std::forward<K>(key);
+    ++leaf->num;
+
+    if (split.node != nullptr) {
+        leaf_t* right = static_cast<leaf_t*>(split.node);
+        split.key   = right->keys[0];
+        split.count = right->num;
+    }
+    return true;
+}
+
+// child goes to children[pos] (pos > 0), its first key to keys[pos - 1]
+template<typename key_type>
+void btree_t<key_type>::insert_child(inner_t* inner, size_t pos, const split_t& child) {
+    std::move_backward(inner->children + pos, inner->children + inner->num,
+                       inner->children + inner->num + 1);
+    std::move_backward(inner->counts + pos, inner->counts + inner->num,
+                       inner->counts + inner->num + 1);
+    std::move_backward(inner->keys + pos - 1, inner->keys + inner->num - 1,
+                       inner->keys + inner->num);
+    inner->children[pos] = child.node;
+    inner->counts[pos]   = child.count;
+    inner->keys[pos - 1] = child.key;
+    ++inner->num;
+}
+
+//-----------------------------------------------------------------------------------------
+
+template<typename key_type>
+const typename btree_t<key_type>::leaf_t* btree_t<key_type>::find_leaf(const key_type& key) const {
+    const node_base_t* node = root_;
+    while (!node->is_leaf) {
+        const inner_t* inner = static_cast<const inner_t*>(node);
+        node = inner->children[child_idx(inner, key)];
+    }
+    return static_cast<const leaf_t*>(node);
+}
+
+template<typename key_type>
+size_t btree_t<key_type>::rank(const key_type& key) const {
+    if (root_ == nullptr)
+        return 0;
+
+    size_t rank = 0;
+    const node_base_t* node = root_;
+    while (!node->is_leaf) {
+        const inner_t* inner = static_cast<const inner_t*>(node);
+        size_t idx = std::lower_bound(inner->keys, inner->keys + inner->num - 1, key) -
+                     inner->keys;
+        for (size_t i = 0; i < idx; ++i)
+            rank += inner->counts[i];
+        node = inner->children[idx];
+    }
+    const leaf_t* leaf = static_cast<const leaf_t*>(node);
+    return rank + (std::lower_bound(leaf->keys, leaf->keys + leaf->num, key) - leaf->keys);
+}
+
+template<typename key_type>
+size_t btree_t<key_type>::rank_upper(const key_type& key) const {
+    if (root_ == nullptr)
+        return 0;
+
+    size_t rank = 0;
+    const node_base_t* node = root_;
+    while (!node->is_leaf) {
+        const inner_t* inner = static_cast<const inner_t*>(node);
+        size_t idx = child_idx(inner, key);
+        for (size_t i = 0; i < idx; ++i)
+            rank += inner->counts[i];
+        node = inner->children[idx];
+    }
+    const leaf_t* leaf = static_cast<const leaf_t*>(node);
+    return rank + (std::upper_bound(leaf->keys, leaf->keys + leaf->num, key) - leaf->keys);
+}
+
+// number of keys in [l_bound, u_bound], 0 if l_bound is not less than u_bound
+template<typename key_type>
+size_t btree_t<key_type>::range_query(const key_type& l_bound, const key_type& u_bound) const {
+    if (!(l_bound < u_bound) || root_ == nullptr)
+        return 0;
+    return rank_upper(u_bound) - rank(l_bound);
+}
+
+template<typename key_type>
+const key_type* btree_t<key_type>::find(const key_type& key) const {
+    const key_type* found = lower_bound(key);
+    if (found == nullptr || key < *found)
+        return nullptr;
+    return found;
+}
+
+template<typename key_type>
+const key_type* btree_t<key_type>::lower_bound(const key_type& key) const {
+    if (root_ == nullptr)
+        return nullptr;
+
+    const leaf_t* leaf = find_leaf(key);
+    size_t pos = std::lower_bound(leaf->keys, leaf->keys + leaf->num, key) - leaf->keys;
+    if (pos < leaf->num)
+        return &leaf->keys[pos];
+    return (leaf->next != nullptr) ? &leaf->next->keys[0] : nullptr;
+}
+
+template<typename key_type>
+const key_type* btree_t<key_type>::upper_bound(const key_type& key) const {
+    if (root_ == nullptr)
+        return nullptr;
+
+    const leaf_t* leaf = find_leaf(key);
+    size_t pos = std::upper_bound(leaf->keys, leaf->keys + leaf->num, key) - leaf->keys;
+    if (pos > 0)
+        return &leaf->keys[pos - 1];
+    return (leaf->prev != nullptr) ? &leaf->prev->keys[leaf->prev->num - 1] : nullptr;
+}
+
+template<typename key_type>
+const key_type* btree_t<key_type>::select(size_t idx) const {
+    if (idx >= size_)
+        return nullptr;
+
+    const node_base_t* node = root_;
+    while (!node->is_leaf) {
+        const inner_t* inner = static_cast<const inner_t*>(node);
+        size_t child = 0;
+        while (idx >= inner->counts[child])
+            idx -= inner->counts[child++];
+        node = inner->children[child];
+    }
+    return &static_cast<const leaf_t*>(node)->keys[idx];
+}
+
+//-----------------------------------------------------------------------------------------
+
+// calls func for keys in [l_bound, u_bound] in sorted order, O(log_B(n) + k)
+template<typename key_type>
+template<typename F>
+void btree_t<key_type>::inorder_walk(const key_type& l_bound, const key_type& u_bound,
+                                     F func) const {
+    if (root_ == nullptr)
+        return;
+
+    const leaf_t* leaf = find_leaf(l_bound);
+    size_t pos = std::lower_bound(leaf->keys, leaf->keys + leaf->num, l_bound) - leaf->keys;
+    for (; leaf != nullptr; leaf = leaf->next, pos = 0) {
+        for (; pos < leaf->num; ++pos) {
+            if (u_bound < leaf->keys[pos])
+                return;
+            func(leaf->keys[pos]);
+        }
+    }
+}
+
+template<typename key_type>
+std::vector<key_type> btree_t<key_type>::store_inorder_walk() const {
+    std::vector<key_type> storage;
+    storage.reserve(size_);
+    for (const leaf_t* leaf = first_leaf_; leaf != nullptr; leaf = leaf->next)
+        storage.insert(storage.end(), leaf->keys, leaf->keys + leaf->num);
+    return storage;
+}
+}
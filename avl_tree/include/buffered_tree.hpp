@@ -0,0 +1,186 @@
+#pragma once
+
+#include "avl_tree.hpp"
+#include <algorithm>
+#include <iterator>
+#include <optional>
+#include <vector>
+
+//-----------------------------------------------------------------------------------------
+
+// Write optimised front of tree_t for ingest bursts: insert only appends the key to a
+// buffer, the tree is not touched. The buffer is merged into the tree in bulk when it
+// reaches max_buffer keys (or at a query if merge_on_query is set): keys are sorted and
+// either inserted in order with finger insertion or, when the buffer is big compared to
+// the tree, merged with the keys of the tree and the tree is rebuilt in O(n).
+//
+// Queries between merges are exact: the buffer is kept as a sorted prefix (unique and
+// absent from the tree for a set) and an unsorted tail, a query sorts the tail into the
+// prefix and adds the answer for the prefix to the answer of the tree.
+
+namespace avl {
+
+struct buffer_config_t {
+    size_t max_buffer     = 1 << 20;  // keys in buffer that start a merge
+    bool   merge_on_query = false;    // queries merge the buffer instead of reading it
+};
+
+template<typename key_type = int, bool is_multi = false, typename balance_type = balance::avl_t>
+class buffered_tree_t final {
+    using tree_type = tree_t<key_type, is_multi, balance_type>;
+
+    // the tree is rebuilt if the buffer has at least 1 / rebuild_ratio of its keys
+    static constexpr size_t rebuild_ratio = 8;
+
+    tree_type tree_;
+    std::vector<key_type> buffer_;
+    size_t num_sorted_ = 0;  // buffer_[0, num_sorted_) is sorted
+    buffer_config_t config_;
+    size_t num_of_merges_ = 0;
+
+    static bool is_equal(const key_type& x, const key_type& y) {return !(x < y) && !(y < x);};
+
+    // sorts the tail of the buffer into the prefix, for a set keys of the tail present in
+    // the tree are dropped only if exclude_tree (a merge does not need it)
+    void prepare(bool exclude_tree = true) {
+        if (num_sorted_ == buffer_.size())
+            return;
+        auto tail = buffer_.begin() + num_sorted_;
+        std::sort(tail, buffer_.end());
+        if constexpr (!is_multi) {
+            auto last = std::unique(tail, buffer_.end(), is_equal);
+            last = std::remove_if(tail, last, [&](const key_type& key) {
+                return std::binary_search(buffer_.begin(), tail, key) ||
+                       (exclude_tree && tree_.find(key).is_valid());
+            });
+            buffer_.erase(last, buffer_.end());
+        }
+        std::inplace_merge(buffer_.begin(), buffer_.begin() + num_sorted_, buffer_.end());
+        num_sorted_ = buffer_.size();
+    }
+
+    size_t buffer_rank(const key_type& key) const {  // buffered keys < key
+        return std::lower_bound(buffer_.begin(), buffer_.end(), key) - buffer_.begin();
+    }
+
+    void prepare_query() {
+        if (config_.merge_on_query)
+            merge();
+        else
+            prepare();
+    }
+
+    public:
+        explicit buffered_tree_t(const buffer_config_t& config = {}) : config_(config) {
+            if (config_.max_buffer == 0)
+                config_.max_buffer = 1;
+        }
+
+        void insert(const key_type& key) {
+            buffer_.push_back(key);
+            if (buffer_.size() >= config_.max_buffer)
+                merge();
+        }
+
+        // moves all buffered keys into the tree
+        void merge() {
+            prepare(false);
+            if (buffer_.empty())
+                return;
+            ++num_of_merges_;
+
+            if (buffer_.size() * rebuild_ratio >= tree_.size()) {
+                std::vector<key_type> tree_keys = tree_.store_inorder_walk();
+                std::vector<key_type> keys;
+                keys.reserve(tree_keys.size() + buffer_.size());
+                if constexpr (is_multi)
+                    std::merge(tree_keys.begin(), tree_keys.end(), buffer_.begin(), buffer_.end(),
+                               std::back_inserter(keys));
+                else
+                    std::set_union(tree_keys.begin(), tree_keys.end(), buffer_.begin(),
+                                   buffer_.end(), std::back_inserter(keys));
+                tree_ = tree_type::build_sorted(keys);
+            }
+            else {
+                for (const auto& key : buffer_)
+                    tree_.insert(key);
+            }
+            buffer_.clear();
+            num_sorted_ = 0;
+        }
+
+        size_t range_query(const key_type& l_bound, const key_type& u_bound) {
+            prepare_query();
+            if (!(l_bound < u_bound))
+                return 0;
+            auto first = std::lower_bound(buffer_.begin(), buffer_.end(), l_bound);
+            auto last  = std::upper_bound(first, buffer_.end(), u_bound);
+            return tree_.range_query(l_bound, u_bound) + (last - first);
+        }
+        size_t rank(const key_type& key) {
+            prepare_query();
+            return tree_.rank(key) + buffer_rank(key);
+        }
+
+        // smallest key >= key, the maximum if there is none, nullopt if there are no keys
+        std::optional<key_type> lower_bound(const key_type& key) {
+            prepare_query();
+            std::optional<key_type> found;
+            if (tree_.size() > 0) {
+                auto node = tree_.lower_bound(key);
+                if (!(node.get_key() < key))
+                    found = node.get_key();
+            }
+            auto it = std::lower_bound(buffer_.begin(), buffer_.end(), key);
+            if (it != buffer_.end() && (!found || *it < *found))
+                found = *it;
+            if (found)
+                return found;
+            return max();
+        }
+        // largest key <= key, the minimum if there is none, nullopt if there are no keys
+        std::optional<key_type> upper_bound(const key_type& key) {
+            prepare_query();
+            std::optional<key_type> found;
+            if (tree_.size() > 0) {
+                auto node = tree_.upper_bound(key);
+                if (!(key < node.get_key()))
+                    found = node.get_key();
+            }
+            auto it = std::upper_bound(buffer_.begin(), buffer_.end(), key);
+            if (it != buffer_.begin() && (!found || *found < *(it - 1)))
+                found = *(it - 1);
+            if (found)
+                return found;
+            return min();
+        }
+        std::optional<key_type> min() {
+            prepare_query();
+            std::optional<key_type> found;
+            if (tree_.size() > 0)
+                found = tree_.select(0).get_key();
+            if (!buffer_.empty() && (!found || buffer_.front() < *found))
+                found = buffer_.front();
+            return found;
+        }
+        std::optional<key_type> max() {
+            prepare_query();
+            std::optional<key_type> found;
+            if (tree_.size() > 0)
+                found = tree_.select(tree_.size() - 1).get_key();
+            if (!buffer_.empty() && (!found || *found < buffer_.back()))
+                found = buffer_.back();
+            return found;
+        }
+
+        size_t size() {
+            prepare();
+            return tree_.size() + buffer_.size();
+        }
+        size_t buffered() const {return buffer_.size();};
+        size_t num_of_merges() const {return num_of_merges_;};
+        // the tree without the buffer, merge() first to see every key
+        const tree_type& tree() const {return tree_;};
+};
+
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include "avl_tree.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+//-----------------------------------------------------------------------------------------
+
+// Read-only compressed copy of the sorted keys of a tree (integral keys, equal keys are
+// allowed). Keys are cut into blocks of block_size, a block stores key - first key of
+// the block (frame of reference) bit packed with the width of its largest difference.
+// The top index keeps first key, bit width and offset of every block uncompressed, the
+// count before a block is its number times block_size.
+//
+// A query does one binary search in the top index and one in a block. Frame of reference
+// (not deltas between neighbours) gives random access to packed keys, so a block is
+// searched by extracting about log2(block_size) keys instead of unpacking all of them.
+
+namespace avl {
+
+template<typename key_type = int>
+class compressed_snapshot_t final {
+    static_assert(std::is_integral_v<key_type>, "snapshot packs integral keys");
+    using ukey_type = std::make_unsigned_t<key_type>;
+
+    static constexpr size_t block_size = 128;
+    static constexpr size_t word_bits  = 64;
+
+    std::vector<key_type> block_first_;   // top index
+    std::vector<uint32_t> block_offset_;  // first word of block in packed_
+    std::vector<uint8_t>  block_bits_;
+    std::vector<uint64_t> packed_;        // one more word at the end for unaligned reads
+    size_t size_ = 0;
+
+    static uint64_t offset(const key_type& key, const key_type& first) {
+        return static_cast<ukey_type>(static_cast<ukey_type>(key) - static_cast<ukey_type>(first));
+    }
+
+    uint64_t packed_at(size_t block, size_t pos) const {
+        size_t bits = block_bits_[block];
+        if (bits == 0)
+            return 0;
+        size_t bit  = pos * bits;
+        size_t word = block_offset_[block] + bit / word_bits;
+        size_t shift = bit % word_bits;
+        uint64_t value = packed_[word] >> shift;
+        if (shift + bits > word_bits)
+            value |= packed_[word + 1] << (word_bits - shift);
+        return (bits == word_bits) ? value : value & ((uint64_t(1) << bits) - 1);
+    }
+    size_t block_len(size_t block) const {
+        return std::min(block_size, size_ - block * block_size);
+    }
+    key_type key_at(size_t block, size_t pos) const {
+        return static_cast<key_type>(static_cast<ukey_type>(block_first_[block]) +
+                                     static_cast<ukey_type>(packed_at(block, pos)));
+    }
+
+    // first position in block with key >= key (or > key if is_upper), the first key of
+    // the block is not greater than key
+    size_t search_block(size_t block, const key_type& key, bool is_upper) const {
+        uint64_t key_offset = offset(key, block_first_[block]);
+        size_t lo = 0, hi = block_len(block);
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            uint64_t value = packed_at(block, mid);
+            if (value < key_offset || (is_upper && value == key_offset))
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    size_t rank_of(const key_type& key, bool is_upper) const {
+        auto it = is_upper ? std::upper_bound(block_first_.begin(), block_first_.end(), key) :
+                             std::lower_bound(block_first_.begin(), block_first_.end(), key);
+        size_t block = it - block_first_.begin();
+        if (block == 0)
+            return 0;
+        return (block - 1) * block_size + search_block(block - 1, key, is_upper);
+    }
+
+    public:
+        compressed_snapshot_t() {};
+        // keys must be sorted
+        explicit compressed_snapshot_t(const std::vector<key_type>& keys) : size_(keys.size()) {
+            assert(std::is_sorted(keys.begin(), keys.end()));
+            size_t num_of_blocks = (size_ + block_size - 1) / block_size;
+            block_first_.reserve(num_of_blocks);
+            block_offset_.reserve(num_of_blocks);
+            block_bits_.reserve(num_of_blocks);
+
+            for (size_t start = 0; start < size_; start += block_size) {
+                size_t len = std::min(block_size, size_ - start);
+                key_type first = keys[start];
+                uint64_t max_offset = offset(keys[start + len - 1], first);
+                size_t bits = 0;
+                while (bits < word_bits && (max_offset >> bits) != 0)
+                    ++bits;
+
+                if (packed_.size() >= UINT32_MAX)
+                    throw("Too many keys for compressed snapshot");
+                block_first_.push_back(first);
+                block_offset_.push_back(static_cast<uint32_t>(packed_.size()));
+                block_bits_.push_back(static_cast<uint8_t>(bits));
+
+                size_t word_start = packed_.size();
+                packed_.resize(word_start + (len * bits + word_bits - 1) / word_bits);
+                for (size_t pos = 0; pos < len && bits > 0; ++pos) {
+                    uint64_t value = offset(keys[start + pos], first);
+                    size_t bit   = pos * bits;
+                    size_t word  = word_start + bit / word_bits;
+                    size_t shift = bit % word_bits;
+                    packed_[word] |= value << shift;
+                    if (shift + bits > word_bits)
+                        packed_[word + 1] |= value >> (word_bits - shift);
+                }
+            }
+            packed_.push_back(0);
+            packed_.shrink_to_fit();
+        }
+        template<bool is_multi, typename balance_type>
+        explicit compressed_snapshot_t(const tree_t<key_type, is_multi, balance_type>& tree) :
+            compressed_snapshot_t(tree.store_inorder_walk()) {};
+
+        size_t size() const {return size_;};
+        // bytes of the packed keys and the top index
+        size_t bytes() const {
+            return packed_.size() * sizeof(uint64_t) + block_first_.size() *
+                   (sizeof(key_type) + sizeof(uint32_t) + sizeof(uint8_t));
+        }
+
+        // number of keys < key
+        size_t rank(const key_type& key) const {return rank_of(key, false);};
+        // number of keys in [l_bound, u_bound], 0 if l_bound is not less than u_bound
+        size_t range_query(const key_type& l_bound, const key_type& u_bound) const {
+            if (!(l_bound < u_bound))
+                return 0;
+            return rank_of(u_bound, true) - rank_of(l_bound, false);
+        }
+        key_type select(size_t idx) const {return key_at(idx / block_size, idx % block_size);};
+
+        // smallest key >= key, nullopt if there is none
+        std::optional<key_type> lower_bound(const key_type& key) const {
+            size_t rank = rank_of(key, false);
+            return (rank < size_) ? std::optional<key_type>(select(rank)) : std::nullopt;
+        }
+        // largest key <= key, nullopt if there is none
+        std::optional<key_type> upper_bound(const key_type& key) const {
+            size_t rank = rank_of(key, true);
+            return (rank > 0) ? std::optional<key_type>(select(rank - 1)) : std::nullopt;
+        }
+
+        std::vector<key_type> store_inorder_walk() const {
+            std::vector<key_type> keys(size_);
+            for (size_t block = 0; block < block_first_.size(); ++block)
+                for (size_t pos = 0; pos < block_len(block); ++pos)
+                    keys[block * block_size + pos] = key_at(block, pos);
+            return keys;
+        }
+};
+
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include "avl_tree.hpp"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+//-----------------------------------------------------------------------------------------
+
+// tree_t shared by many reading and writing threads. Every insert or erase changes size_
+// of all nodes up to the root, so writers always meet at the root and locks on nodes
+// would only serialise them later. Writers are combined instead: a writer publishes its
+// request and the thread that gets the tree lock applies all published requests in key
+// order (finger insertion makes it cheap) and wakes their owners. Readers share the lock,
+// so every operation is linearizable and range_query always sees consistent sizes.
+
+namespace avl {
+
+template<typename key_type = int, bool is_multi = false, typename balance_type = balance::avl_t>
+class concurrent_tree_t final {
+    enum class op_t {insert, erase};
+
+    struct request_t {
+        key_type key;
+        op_t     op;
+        size_t   result = 0;
+        std::exception_ptr error;
+        std::atomic<bool>  is_done {false};
+
+        request_t(const key_type& req_key, op_t req_op) : key(req_key), op(req_op) {};
+    };
+
+    static constexpr size_t max_combine_rounds = 8;  // the combiner does not serve forever
+
+    tree_t<key_type, is_multi, balance_type> tree_;
+    mutable std::shared_mutex tree_lock_;
+
+    std::mutex pending_lock_;
+    std::vector<request_t*> pending_;   // published requests, under pending_lock_
+    std::vector<request_t*> applying_;  // taken by the combiner, under tree_lock_
+    size_t num_of_combines_ = 0;
+
+    // both called with tree_lock_ held exclusively
+    size_t apply(const key_type& key, op_t op) {
+        if (op == op_t::erase)
+            return tree_.erase(key);
+        size_t old_size = tree_.size();
+        tree_.insert(key);
+        return tree_.size() - old_size;
+    }
+    void combine() {
+        for (size_t round = 0; round < max_combine_rounds; ++round) {
+            {
+                std::lock_guard<std::mutex> lock(pending_lock_);
+                if (pending_.empty())
+                    return;
+                applying_.swap(pending_);
+            }
+            ++num_of_combines_;
+            // requests of one thread are never pending together, so any order is valid
+            std::stable_sort(applying_.begin(), applying_.end(),
+                             [](const request_t* lhs, const request_t* rhs) {
+                return lhs->key < rhs->key;
+            });
+            for (request_t* req : applying_) {
+                try {
+                    req->result = apply(req->key, req->op);
+                }
+                catch (...) {
+                    req->error = std::current_exception();
+                }
+                req->is_done.store(true, std::memory_order_release);
+            }
+            applying_.clear();
+        }
+    }
+
+    size_t submit(const key_type& key, op_t op) {
+        {   // uncontended: no publication
+            std::unique_lock<std::shared_mutex> lock(tree_lock_, std::try_to_lock);
+            if (lock.owns_lock()) {
+                size_t result = apply(key, op);
+                combine();
+                return result;
+            }
+        }
+        request_t req {key, op};
+        {
+            std::lock_guard<std::mutex> lock(pending_lock_);
+            pending_.push_back(&req);
+        }
+        while (!req.is_done.load(std::memory_order_acquire)) {
+            std::unique_lock<std::shared_mutex> lock(tree_lock_, std::try_to_lock);
+            if (lock.owns_lock())
+                combine();
+            else
+                std::this_thread::yield();
+        }
+        if (req.error)
+            std::rethrow_exception(req.error);
+        return req.result;
+    }
+
+    public:
+        concurrent_tree_t() {};
+        concurrent_tree_t(const concurrent_tree_t& tree) = delete;
+        concurrent_tree_t& operator= (const concurrent_tree_t& tree) = delete;
+
+        // returns 1 if the key was added (always in multiset)
+        size_t insert(const key_type& key) {return submit(key, op_t::insert);};
+        // returns number of erased elements
+        size_t erase(const key_type& key)  {return submit(key, op_t::erase);};
+
+        size_t range_query(const key_type& l_bound, const key_type& u_bound) const {
+            std::shared_lock<std::shared_mutex> lock(tree_lock_);
+            return tree_.range_query(l_bound, u_bound);
+        }
+        size_t rank(const key_type& key) const {
+            std::shared_lock<std::shared_mutex> lock(tree_lock_);
+            return tree_.rank(key);
+        }
+        size_t count(const key_type& key) const {
+            std::shared_lock<std::shared_mutex> lock(tree_lock_);
+            return tree_.count(key);
+        }
+        size_t size() const {
+            std::shared_lock<std::shared_mutex> lock(tree_lock_);
+            return tree_.size();
+        }
+        // keys are returned by value, the node may be erased right after the call.
+        // As in tree_t: smallest key >= key, the maximum if there is none, nullopt if
+        // there are no keys
+        std::optional<key_type> lower_bound(const key_type& key) const {
+            std::shared_lock<std::shared_mutex> lock(tree_lock_);
+            if (tree_.size() == 0)
+                return std::nullopt;
+            return tree_.lower_bound(key).get_key();
+        }
+        // largest key <= key, the minimum if there is none, nullopt if there are no keys
+        std::optional<key_type> upper_bound(const key_type& key) const {
+            std::shared_lock<std::shared_mutex> lock(tree_lock_);
+            if (tree_.size() == 0)
+                return std::nullopt;
+            return tree_.upper_bound(key).get_key();
+        }
+
+        // runs func(const tree_t&) on a state no writer changes meanwhile, for several
+        // queries that must agree with each other
+        template<typename F>
+        auto read(F func) const {
+            std::shared_lock<std::shared_mutex> lock(tree_lock_);
+            return func(tree_);
+        }
+
+        size_t num_of_combines() const {
+            std::shared_lock<std::shared_mutex> lock(tree_lock_);
+            return num_of_combines_;
+        }
+};
+
+}
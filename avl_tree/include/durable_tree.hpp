@@ -0,0 +1,308 @@
+#pragma once
+
+#include "avl_tree.hpp"
+#include <string>
+#include <cstring>
+#include <cerrno>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//-----------------------------------------------------------------------------------------
+
+// Durability layer around tree_t: every mutation is appended to a write-ahead journal
+// before it is applied. Records are grouped and synced together, and from time to time
+// the whole key set is written to a checkpoint, after which the journal starts anew.
+//
+// insert() returns before its record is on disk: records of the current group are kept
+// in memory until group_size of them are collected, so a crash loses up to group_size - 1
+// inserts that already returned. commit() is the durability point - the keys inserted
+// before it returns survive a crash. group_size = 1 commits every insert.
+//
+// dir/checkpoint.dat : checkpoint_header_t + sorted keys
+// dir/journal.log    : records {key bytes, 32-bit checksum of the key}
+
+namespace avl {
+
+struct journal_config_t {
+    size_t group_size       = 1024;     // records written and synced together, see commit()
+    size_t checkpoint_every = 1 << 20;  // records between checkpoints, 0 - never
+    bool   sync             = true;     // fdatasync every group
+};
+
+namespace journal {
+
+constexpr uint64_t checkpoint_magic = 0x0031544b434c5641; // "AVLCKT1"
+
+struct checkpoint_header_t {
+    uint64_t magic;
+    uint32_t key_size;
+    uint32_t reserved;
+    uint64_t count;
+    uint64_t checksum;   // FNV-1a of the keys
+};
+
+inline void write_all(int fd, const void* data, size_t len) {
+    const char* bytes = static_cast<const char*>(data);
+    while (len > 0) {
+        ssize_t written = ::write(fd, bytes, len);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            throw("Can not write journal");
+        }
+        bytes += written;
+        len   -= static_cast<size_t>(written);
+    }
+}
+
+inline std::vector<char> read_all(int fd) {
+    std::vector<char> storage;
+    char buf[1 << 16];
+    while (true) {
+        ssize_t num = ::read(fd, buf, sizeof(buf));
+        if (num < 0) {
+            if (errno == EINTR)
+                continue;
+            throw("Can not read journal");
+        }
+        if (num == 0)
+            break;
+        storage.insert(storage.end(), buf, buf + num);
+    }
+    return storage;
+}
+
+inline void sync_dir(const std::string& dir) {
+    int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0)
+        return;
+    ::fsync(fd);
+    ::close(fd);
+}
+
+}
+
+//-----------------------------------------------------------------------------------------
+
+template<typename key_type = int>
+class durable_tree_t final {
+    static_assert(std::is_trivially_copyable_v<key_type>,
+                  "journal records store keys byte by byte");
+    static constexpr size_t record_size = sizeof(key_type) + sizeof(uint32_t);
+
+    tree_t<key_type> tree_;
+    journal_config_t config_;
+    std::string dir_;
+    std::string log_path_;
+    std::string checkpoint_path_;
+    int log_fd_ = -1;
+
+    std::vector<char> group_;
+    size_t group_num_        = 0;
+    size_t since_checkpoint_ = 0;
+
+    static uint32_t key_checksum(const key_type& key) {
+        return static_cast<uint32_t>(fnv1a_hash(&key, sizeof(key_type)));
+    }
+    void load_checkpoint();
+    void replay_journal();
+    void append(const key_type& key);
+
+    public:
+        durable_tree_t(const std::string& dir, journal_config_t config = {});
+        ~durable_tree_t();
+
+        durable_tree_t(const durable_tree_t<key_type>& tree) = delete;
+        durable_tree_t<key_type>& operator= (const durable_tree_t<key_type>& tree) = delete;
+
+        // the key is durable only after the group is full or commit() returns
+        void insert(const key_type& key);
+        template<typename... Args>
+        void emplace(Args&&... args);
+
+        // writes and syncs the pending records, all keys inserted before are durable
+        void commit();
+        void checkpoint();
+
+        const tree_t<key_type>& tree() const {return tree_;};
+        size_t range_query(const key_type& l_bound, const key_type& u_bound) const {
+            return tree_.range_query(l_bound, u_bound);
+        }
+};
+
+//-----------------------------------------------------------------------------------------
+
+template<typename key_type>
+durable_tree_t<key_type>::durable_tree_t(const std::string& dir, journal_config_t config) :
+    config_(config),
+    dir_(dir),
+    log_path_(dir + "/journal.log"),
+    checkpoint_path_(dir + "/checkpoint.dat") {
+
+    if (::mkdir(dir_.c_str(), 0755) != 0 && errno != EEXIST)
+        throw("Can not create journal directory");
+
+    load_checkpoint();
+
+    log_fd_ = ::open(log_path_.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (log_fd_ < 0)
+        throw("Can not open journal");
+    replay_journal();
+
+    group_.reserve(config_.group_size * record_size);
+}
+
+template<typename key_type>
+durable_tree_t<key_type>::~durable_tree_t() {
+    try {
+        commit();
+    }
+    catch (...) {}
+    if (log_fd_ >= 0)
+        ::close(log_fd_);
+}
+
+//-----------------------------------------------------------------------------------------
+
+template<typename key_type>
+void durable_tree_t<key_type>::load_checkpoint() {
+    int fd = ::open(checkpoint_path_.c_str(), O_RDONLY);
+    if (fd < 0) {
+        if (errno == ENOENT)
+            return;
+        throw("Can not open checkpoint");
+    }
+    std::vector<char> data = journal::read_all(fd);
+    ::close(fd);
+
+    journal::checkpoint_header_t header {};
+    if (data.size() < sizeof(header))
+        throw("Checkpoint is truncated");
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != journal::checkpoint_magic || header.key_size != sizeof(key_type))
+        throw("Checkpoint does not match key type");
+    if (data.size() != sizeof(header) + header.count * sizeof(key_type))
+        throw("Checkpoint is truncated");
+
+    std::vector<key_type> keys(header.count);
+    std::memcpy(keys.data(), data.data() + sizeof(header), header.count * sizeof(key_type));
+    if (fnv1a_hash(keys.data(), keys.size() * sizeof(key_type)) != header.checksum)
+        throw("Checkpoint is corrupted");
+
+    tree_ = tree_t<key_type>::build_sorted(keys);
+}
+
+// replays records after the last checkpoint, a torn tail of the journal is cut off
+template<typename key_type>
+void durable_tree_t<key_type>::replay_journal() {
+    std::vector<char> data = journal::read_all(log_fd_);
+
+    size_t offset = 0;
+    for (; offset + record_size <= data.size(); offset += record_size) {
+        key_type key;
+        uint32_t checksum = 0;
+        std::memcpy(&key, data.data() + offset, sizeof(key_type));
+        std::memcpy(&checksum, data.data() + offset + sizeof(key_type), sizeof(checksum));
+        if (checksum != key_checksum(key))
+            break;
+
+        tree_.insert(key);
+        ++since_checkpoint_;
+    }
+    if (offset != data.size() && ::ftruncate(log_fd_, offset) != 0)
+        throw("Can not truncate journal");
+}
+
+//-----------------------------------------------------------------------------------------
+
+template<typename key_type>
+void durable_tree_t<key_type>::append(const key_type& key) {
+    uint32_t checksum = key_checksum(key);
+    const char* key_bytes      = reinterpret_cast<const char*>(&key);
+    const char* checksum_bytes = reinterpret_cast<const char*>(&checksum);
+    group_.insert(group_.end(), key_bytes, key_bytes + sizeof(key_type));
+    group_.insert(group_.end(), checksum_bytes, checksum_bytes + sizeof(checksum));
+    ++group_num_;
+}
+
+template<typename key_type>
+void durable_tree_t<key_type>::insert(const key_type& key) {
+    append(key);
+    tree_.insert(key);
+
+    ++since_checkpoint_;
+    if (group_num_ >= config_.group_size)
+        commit();
+    if (config_.checkpoint_every && since_checkpoint_ >= config_.checkpoint_every)
+        checkpoint();
+}
+
+template<typename key_type>
+template<typename... Args>
+void durable_tree_t<key_type>::emplace(Args&&... args) {
+    key_type key = {std::forward<Args>(args)...};
+    append(key);
+    tree_.emplace(std::move(key));
+
+    ++since_checkpoint_;
+    if (group_num_ >= config_.group_size)
+        commit();
+    if (config_.checkpoint_every && since_checkpoint_ >= config_.checkpoint_every)
+        checkpoint();
+}
+
+// writes pending group of records with one write and one fdatasync
+template<typename key_type>
+void durable_tree_t<key_type>::commit() {
+    if (group_num_ == 0)
+        return;
+
+    journal::write_all(log_fd_, group_.data(), group_.size());
+    if (config_.sync && ::fdatasync(log_fd_) != 0)
+        throw("Can not sync journal");
+
+    group_.clear();
+    group_num_ = 0;
+}
+
+template<typename key_type>
+void durable_tree_t<key_type>::checkpoint() {
+    commit();
+
+    std::vector<key_type> keys = tree_.store_inorder_walk();
+    journal::checkpoint_header_t header {};
+    header.magic    = journal::checkpoint_magic;
+    header.key_size = sizeof(key_type);
+    header.count    = keys.size();
+    header.checksum = fnv1a_hash(keys.data(), keys.size() * sizeof(key_type));
+
+    std::string tmp_path = checkpoint_path_ + ".tmp";
+    int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        throw("Can not open checkpoint");
+    try {
+        journal::write_all(fd, &header, sizeof(header));
+        journal::write_all(fd, keys.data(), keys.size() * sizeof(key_type));
+    }
+    catch (...) {
+        ::close(fd);
+        throw;
+    }
+    bool is_synced = !config_.sync || ::fsync(fd) == 0;
+    ::close(fd);
+    if (!is_synced || ::rename(tmp_path.c_str(), checkpoint_path_.c_str()) != 0)
+        throw("Can not write checkpoint");
+    if (config_.sync)
+        journal::sync_dir(dir_);
+
+    // replaying already checkpointed keys is harmless, so a crash before this point
+    // only costs a longer recovery
+    if (::ftruncate(log_fd_, 0) != 0)
+        throw("Can not truncate journal");
+    if (config_.sync)
+        ::fdatasync(log_fd_);
+    since_checkpoint_ = 0;
+}
+}
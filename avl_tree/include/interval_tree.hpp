@@ -0,0 +1,130 @@
+#pragma once
+
+#include "avl_tree.hpp"
+#include <limits>
+#include <stack>
+#include <vector>
+
+//-----------------------------------------------------------------------------------------
+
+// Closed intervals [low, high] in a multiset ordered by (low, high). The key carries an
+// augmentation (see augment_base_t in avl_node.hpp): every node knows the maximum high of
+// its subtree, rotations keep it valid, so overlap reporting skips the subtrees that end
+// before the query. It still visits the union of the root paths to the k reported
+// intervals, which is O(log(n) + k * log(n / k)) and at worst O(k * log(n)), not the
+// O(log(n) + k) of a centered interval tree or a priority search tree.
+//
+// Counting is done by ranks: the intervals overlapping [l_bound, u_bound] are those with
+// low <= u_bound minus those with high < l_bound, the second rank is taken from a
+// multiset of high ends, so both counts are O(log(n)).
+
+namespace avl {
+
+template<typename point_type>
+struct interval_t {
+    point_type low;
+    point_type high;
+
+    using augment_type = point_type;  // maximum high in a subtree
+    static point_type augment(const interval_t& interval) {return interval.high;};
+    static point_type combine(const point_type& left, const point_type& right) {
+        return (left < right) ? right : left;
+    }
+
+    bool overlaps(const point_type& l_bound, const point_type& u_bound) const {
+        return !(u_bound < low) && !(high < l_bound);
+    }
+    bool operator<(const interval_t& rhs) const {
+        return low < rhs.low || (!(rhs.low < low) && high < rhs.high);
+    }
+    bool operator>(const interval_t& rhs) const {return rhs < *this;};
+    bool operator==(const interval_t& rhs) const {return !(*this < rhs) && !(rhs < *this);};
+};
+
+template<typename point_type = int, typename balance_type = balance::avl_t>
+class interval_tree_t final {
+    using interval_type = interval_t<point_type>;
+    using node_type     = node_t<interval_type>;
+
+    multiset_t<interval_type, balance_type> intervals_;
+    multiset_t<point_type, balance_type>    highs_;
+
+    // number of intervals with low <= point
+    size_t num_low_not_greater(const point_type& point) const {
+        using limits = std::numeric_limits<point_type>;
+        interval_type last {point, limits::has_infinity ? limits::infinity() : limits::max()};
+        return intervals_.rank(last) + intervals_.count(last);
+    }
+
+    public:
+        void insert(const point_type& low, const point_type& high) {
+            if (high < low)
+                throw("Interval must have low <= high");
+            intervals_.insert({low, high});
+            highs_.insert(high);
+        }
+        // erases one copy of [low, high], returns 1 if it was present
+        size_t erase(const point_type& low, const point_type& high) {
+            if (intervals_.erase_one({low, high}) == 0)
+                return 0;
+            return highs_.erase_one(high);
+        }
+
+        size_t size() const {return intervals_.size();};
+
+        // number of intervals that have common points with [l_bound, u_bound]
+        size_t count_overlaps(const point_type& l_bound, const point_type& u_bound) const {
+            if (u_bound < l_bound)
+                return 0;
+            return num_low_not_greater(u_bound) - highs_.rank(l_bound);
+        }
+        // number of intervals that contain point
+        size_t count_stabbing(const point_type& point) const {
+            return count_overlaps(point, point);
+        }
+
+        // calls func(interval) for every interval (every copy of it) overlapping
+        // [l_bound, u_bound] in order of low ends
+        template<typename F>
+        void overlaps(const point_type& l_bound, const point_type& u_bound, F func) const {
+            if (u_bound < l_bound)
+                return;
+            std::stack<const node_type*> node_stk;
+            const node_type* cur_node = intervals_.get_root();
+
+            while (cur_node || !node_stk.empty()) {
+                // left subtrees that end before l_bound are not visited
+                while (cur_node && !(cur_node->get_augment() < l_bound)) {
+                    node_stk.push(cur_node);
+                    cur_node = cur_node->get_left().get();
+                }
+                if (node_stk.empty())
+                    return;
+                cur_node = node_stk.top();
+                node_stk.pop();
+
+                const interval_type& interval = cur_node->get_key();
+                if (u_bound < interval.low)   // the rest starts after u_bound
+                    return;
+                if (interval.overlaps(l_bound, u_bound))
+                    for (size_t i = 0; i < cur_node->get_count(); ++i)
+                        func(interval);
+                cur_node = cur_node->get_right().get();
+            }
+        }
+        std::vector<interval_type> overlaps(const point_type& l_bound,
+                                            const point_type& u_bound) const {
+            std::vector<interval_type> found;
+            overlaps(l_bound, u_bound, [&](const interval_type& interval) {
+                found.push_back(interval);
+            });
+            return found;
+        }
+        std::vector<interval_type> stabbing(const point_type& point) const {
+            return overlaps(point, point);
+        }
+
+        const multiset_t<interval_type, balance_type>& intervals() const {return intervals_;};
+};
+
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+//-----------------------------------------------------------------------------------------
+
+// Slab storage for tree nodes. Memory is taken from the heap in chunks and is never
+// given back: a released node goes to the free list of the releasing thread and is
+// reused by the next allocation of that thread. Since no chunk is ever freed, a node
+// may be allocated and released by different threads.
+//
+// When a thread exits its free slots (and the rest of its chunk) go to a shared list,
+// a thread whose own list and chunk are empty takes the shared list before it asks the
+// heap for a new chunk. So nodes released by short-lived threads are not lost.
+
+namespace avl {
+
+template<typename node_type>
+class node_pool_t final {
+    union slot_t {
+        slot_t* next;
+        alignas(node_type) unsigned char storage[sizeof(node_type)];
+    };
+
+    struct local_t {
+        slot_t* free_list  = nullptr;
+        slot_t* chunk_cur  = nullptr;
+        slot_t* chunk_end  = nullptr;
+        bool    is_exiting = false;  // slots released from now on go to the shared list
+    };
+
+    struct shared_t {
+        std::mutex mtx;
+        std::vector<slot_t*> chunks;  // keeps chunks reachable
+        slot_t* free_list = nullptr;
+        size_t num_of_slots = 0;      // slots taken from the heap
+    };
+
+    // never destroyed, threads may release nodes during exit
+    static shared_t& shared() {
+        static shared_t* shared = new shared_t;
+        return *shared;
+    }
+
+    // trivially destructible, so it stays usable while thread locals are destroyed
+    static local_t& local() {
+        thread_local local_t local;
+        return local;
+    }
+
+    // gives free slots of the thread to the shared list at thread exit
+    struct exit_guard_t {
+        ~exit_guard_t() {
+            local_t& loc = local();
+            loc.is_exiting = true;
+            while (loc.chunk_cur != loc.chunk_end) {
+                slot_t* slot  = loc.chunk_cur++;
+                slot->next    = loc.free_list;
+                loc.free_list = slot;
+            }
+            if (loc.free_list == nullptr)
+                return;
+
+            slot_t* tail = loc.free_list;
+            while (tail->next != nullptr)
+                tail = tail->next;
+            shared_t& shr = shared();
+            std::lock_guard<std::mutex> lock(shr.mtx);
+            tail->next    = shr.free_list;
+            shr.free_list = std::exchange(loc.free_list, nullptr);
+        }
+    };
+    static void guard_exit() {
+        thread_local exit_guard_t guard;
+        (void)guard;
+    }
+
+    static slot_t* allocate_chunk(size_t num) {
+        slot_t* chunk = static_cast<slot_t*>(
+                        ::operator new(num * sizeof(slot_t), std::align_val_t{alignof(slot_t)}));
+        shared_t& shr = shared();
+        std::lock_guard<std::mutex> lock(shr.mtx);
+        shr.chunks.push_back(chunk);
+        shr.num_of_slots += num;
+        return chunk;
+    }
+
+    static slot_t* take_shared_list() {
+        shared_t& shr = shared();
+        std::lock_guard<std::mutex> lock(shr.mtx);
+        return std::exchange(shr.free_list, nullptr);
+    }
+
+    public:
+        static constexpr size_t chunk_size = 256;
+        static constexpr size_t slot_size  = sizeof(slot_t);
+
+        static void* allocate() {
+            local_t& loc = local();
+            if (loc.free_list == nullptr && loc.chunk_cur == loc.chunk_end && !loc.is_exiting) {
+                guard_exit();
+                loc.free_list = take_shared_list();
+            }
+            if (loc.free_list != nullptr) {
+                slot_t* slot  = loc.free_list;
+                loc.free_list = slot->next;
+                return slot;
+            }
+            if (loc.chunk_cur == loc.chunk_end) {
+                loc.chunk_cur = allocate_chunk(chunk_size);
+                loc.chunk_end = loc.chunk_cur + chunk_size;
+            }
+            return loc.chunk_cur++;
+        }
+
+        // num contiguous slots, slot i starts at block + i * slot_size
+        static void* allocate_block(size_t num) {
+            return allocate_chunk(num);
+        }
+
+        static void deallocate(void* ptr) {
+            local_t& loc = local();
+            slot_t*  slot = static_cast<slot_t*>(ptr);
+            if (loc.is_exiting) {
+                shared_t& shr = shared();
+                std::lock_guard<std::mutex> lock(shr.mtx);
+                slot->next    = shr.free_list;
+                shr.free_list = slot;
+                return;
+            }
+            if (loc.free_list == nullptr)
+                guard_exit();
+            slot->next    = loc.free_list;
+            loc.free_list = slot;
+        }
+
+        // slots taken from the heap so far by all threads
+        static size_t num_of_slots() {
+            shared_t& shr = shared();
+            std::lock_guard<std::mutex> lock(shr.mtx);
+            return shr.num_of_slots;
+        }
+};
+
+template<typename node_type>
+struct node_deleter_t {
+    void operator()(node_type* node) const {
+        node->~node_type();
+        node_pool_t<node_type>::deallocate(node);
+    }
+};
+
+}
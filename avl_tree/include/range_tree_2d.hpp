@@ -0,0 +1,108 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+//-----------------------------------------------------------------------------------------
+
+// Static 2-D orthogonal range counting: number of points in [x_l, x_u] x [y_l, y_u].
+// Points are built offline into a balanced tree over x order (node covers an interval of
+// x ranks, children split it in halves). Instead of a sorted array of y in every node,
+// as in the classic range tree, every level keeps for each position of a node block (in
+// y order) the number of its elements that went to the left child: one binary search
+// on y at the root gives the y ranks, and they are carried down the levels in O(1) each
+// (fractional cascading). count is O(log(n)), memory is O(n * log(n)) 32-bit counters.
+//
+// Like tree_t only operator< of the coordinates is used, counts on each axis are a
+// difference of ranks, bounds are inclusive and a range with u < l is empty.
+
+namespace avl {
+
+template<typename x_type = int, typename y_type = int>
+class range_tree_2d_t final {
+    std::vector<x_type> xs_;                   // x of the points, sorted
+    std::vector<y_type> ys_;                   // y of the points, sorted
+    std::vector<std::vector<uint32_t>> left_;  // left_[level][pos], see left_rank
+    size_t size_ = 0;
+
+    // elements among the first rank ones (in y order) of block [lo, hi) that belong to
+    // the left child [lo, mid)
+    size_t left_rank(size_t level, size_t lo, size_t hi, size_t rank) const {
+        return (rank == hi - lo) ? (hi - lo) / 2 : left_[level][lo + rank];
+    }
+
+    // order[lo, hi) has the x ranks of the node in y order, children get their halves
+    void build(size_t level, size_t lo, size_t hi, std::vector<uint32_t>& order) {
+        if (hi - lo < 2)
+            return;
+        if (left_.size() == level)
+            left_.emplace_back(size_);
+        size_t mid = lo + (hi - lo) / 2;
+        uint32_t num_left = 0;
+        for (size_t pos = lo; pos < hi; ++pos) {
+            left_[level][pos] = num_left;
+            num_left += (order[pos] < mid);
+        }
+        std::stable_partition(order.begin() + lo, order.begin() + hi,
+                              [mid](uint32_t x_rank) {return x_rank < mid;});
+        build(level + 1, lo, mid, order);
+        build(level + 1, mid, hi, order);
+    }
+
+    size_t count(size_t level, size_t lo, size_t hi, size_t y_lo, size_t y_hi,
+                 size_t x_lo, size_t x_hi) const {
+        if (y_lo >= y_hi || x_hi <= lo || hi <= x_lo)
+            return 0;
+        if (x_lo <= lo && hi <= x_hi)
+            return y_hi - y_lo;
+        size_t mid = lo + (hi - lo) / 2;
+        size_t left_lo = left_rank(level, lo, hi, y_lo);
+        size_t left_hi = left_rank(level, lo, hi, y_hi);
+        return count(level + 1, lo, mid, left_lo, left_hi, x_lo, x_hi) +
+               count(level + 1, mid, hi, y_lo - left_lo, y_hi - left_hi, x_lo, x_hi);
+    }
+
+    public:
+        range_tree_2d_t() {};
+        explicit range_tree_2d_t(std::vector<std::pair<x_type, y_type>> points) :
+            size_(points.size()) {
+            if (size_ >= UINT32_MAX)
+                throw("Too many points for range_tree_2d_t");
+            std::sort(points.begin(), points.end(), [](const auto& lhs, const auto& rhs) {
+                return lhs.first < rhs.first;
+            });
+            xs_.reserve(size_);
+            for (const auto& point : points)
+                xs_.push_back(point.first);
+
+            // x ranks of the points in y order
+            std::vector<uint32_t> order(size_);
+            for (size_t i = 0; i < size_; ++i)
+                order[i] = static_cast<uint32_t>(i);
+            std::stable_sort(order.begin(), order.end(), [&](uint32_t lhs, uint32_t rhs) {
+                return points[lhs].second < points[rhs].second;
+            });
+            ys_.reserve(size_);
+            for (uint32_t x_rank : order)
+                ys_.push_back(points[x_rank].second);
+            build(0, 0, size_, order);
+        }
+
+        // number of points in [x_l, x_u] x [y_l, y_u]
+        size_t count(const x_type& x_l, const x_type& x_u,
+                     const y_type& y_l, const y_type& y_u) const {
+            if (x_u < x_l || y_u < y_l || size_ == 0)
+                return 0;
+            size_t x_lo = std::lower_bound(xs_.begin(), xs_.end(), x_l) - xs_.begin();
+            size_t x_hi = std::upper_bound(xs_.begin(), xs_.end(), x_u) - xs_.begin();
+            size_t y_lo = std::lower_bound(ys_.begin(), ys_.end(), y_l) - ys_.begin();
+            size_t y_hi = std::upper_bound(ys_.begin(), ys_.end(), y_u) - ys_.begin();
+            return count(0, 0, size_, y_lo, y_hi, x_lo, x_hi);
+        }
+
+        size_t size() const {return size_;};
+};
+
+}
@@ -0,0 +1,227 @@
+#pragma once
+
+#include "tree_image.hpp"
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+//-----------------------------------------------------------------------------------------
+
+// Tree image in POSIX shared memory, published by one writer process and read by many
+// reader processes, so the key set is held in memory once. The object holds a header
+// and two slots of the same capacity, each slot is an image of tree_image.hpp:
+//
+//  shm_header_t | slot 0: image::header_t + nodes | slot 1: image::header_t + nodes
+//
+// publish() writes the new image into the slot that is not active and switches active
+// to it (double buffering). A reader pins the active slot with a counter of the slot and
+// reads it without any lock; the writer overwrites a slot only when no reader pins it,
+// so readers never wait and never see a half written image. Counters are lock-free
+// atomics, which work across processes on a shared mapping.
+
+namespace avl {
+namespace image {
+
+constexpr uint64_t shm_magic   = 0x0031484d534c5641; // "AVLSHM1"
+constexpr size_t   slot_align  = 64;
+
+struct shm_header_t {
+    std::atomic<uint64_t> magic;          // set when the object is ready
+    uint32_t key_kind;
+    uint32_t node_size;
+    uint64_t slot_capacity;               // bytes of one slot
+    uint64_t slot_offset;                 // offset of slot 0 from the header
+    std::atomic<uint64_t> generation;     // number of published images
+    std::atomic<uint32_t> active;         // slot of the current image
+    std::atomic<uint32_t> readers[2];     // readers pinning a slot
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free &&
+              std::atomic<uint64_t>::is_always_lock_free,
+              "shared image needs address free atomics");
+
+inline void* map_shm(const std::string& name, int flags, size_t& len) {
+    int fd = ::shm_open(name.c_str(), flags, 0644);
+    if (fd < 0)
+        throw("Can not open shared memory object");
+
+    if (flags & O_CREAT) {
+        if (::ftruncate(fd, static_cast<off_t>(len)) != 0) {
+            ::close(fd);
+            throw("Can not resize shared memory object");
+        }
+    }
+    else {
+        struct stat st {};
+        if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(shm_header_t)) {
+            ::close(fd);
+            throw("Shared memory object is not a tree image");
+        }
+        len = static_cast<size_t>(st.st_size);
+    }
+    void* data = ::mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+        throw("Can not map shared memory object");
+    return data;
+}
+
+}
+
+//-----------------------------------------------------------------------------------------
+
+// The only writer of a shared image. Creates (or truncates) the shared memory object
+// "name" (as for shm_open, "/name") with room for max_keys keys in every slot.
+template<typename key_type = int>
+class shared_image_writer_t final {
+    std::string name_;
+    void*  data_ = nullptr;
+    size_t len_  = 0;
+
+    image::shm_header_t* header() const {return static_cast<image::shm_header_t*>(data_);};
+    char* slot(uint32_t idx) const {
+        return static_cast<char*>(data_) + header()->slot_offset + idx * header()->slot_capacity;
+    }
+
+    public:
+        shared_image_writer_t(const std::string& name, size_t max_keys) : name_(name) {
+            static_assert(std::is_trivially_copyable_v<key_type>,
+                          "image keys are written byte by byte");
+            if (max_keys >= image::null_idx)
+                throw("Too many keys for shared image");
+
+            size_t slot_offset = (sizeof(image::shm_header_t) + image::slot_align - 1) /
+                                 image::slot_align * image::slot_align;
+            size_t capacity = (image::image_size<key_type>(max_keys) + image::slot_align - 1) /
+                              image::slot_align * image::slot_align;
+            len_  = slot_offset + 2 * capacity;
+            data_ = image::map_shm(name_, O_CREAT | O_RDWR, len_);
+
+            auto* shm = new (data_) image::shm_header_t {};
+            shm->key_kind      = static_cast<uint32_t>(image::key_kind<key_type>());
+            shm->node_size     = sizeof(image::node_t<key_type>);
+            shm->slot_capacity = capacity;
+            shm->slot_offset   = slot_offset;
+            publish(tree_t<key_type>{});
+            shm->magic.store(image::shm_magic, std::memory_order_release);
+        }
+        ~shared_image_writer_t() {
+            if (data_ != nullptr)
+                ::munmap(data_, len_);
+        }
+        shared_image_writer_t(const shared_image_writer_t& writer) = delete;
+        shared_image_writer_t& operator= (const shared_image_writer_t& writer) = delete;
+
+        // writes tree into the free slot and makes it current. Waits for readers still
+        // pinning that slot (they read the image before the current one) at most timeout.
+        void publish(const tree_t<key_type>& tree,
+                     std::chrono::milliseconds timeout = std::chrono::seconds(1)) {
+            if (image::image_size<key_type>(tree.size()) > header()->slot_capacity)
+                throw("Tree is too big for shared image");
+
+            auto* shm = header();
+            uint32_t target = 1 - shm->active.load();
+            auto deadline = std::chrono::steady_clock::now() + timeout;
+            while (shm->readers[target].load() != 0) {
+                if (std::chrono::steady_clock::now() > deadline)
+                    throw("Readers do not release the old shared image");
+                std::this_thread::yield();
+            }
+
+            std::vector<image::node_t<key_type>> nodes = image::store_nodes(tree);
+            image::header_t image_header = image::make_header(tree, nodes);
+            char* dst = slot(target);
+            std::memcpy(dst, &image_header, sizeof(image_header));
+            if (!nodes.empty())
+                std::memcpy(dst + sizeof(image_header), nodes.data(),
+                            nodes.size() * sizeof(image::node_t<key_type>));
+
+            shm->active.store(target);
+            shm->generation.fetch_add(1);
+        }
+
+        uint64_t generation() const {return header()->generation.load();};
+
+        static void unlink(const std::string& name) {::shm_unlink(name.c_str());};
+};
+
+//-----------------------------------------------------------------------------------------
+
+// Reader of a shared image: queries run on the image that is current when they start.
+template<typename key_type = int>
+class shared_tree_t final {
+    void*  data_ = nullptr;
+    size_t len_  = 0;
+
+    image::shm_header_t* header() const {return static_cast<image::shm_header_t*>(data_);};
+
+    public:
+        explicit shared_tree_t(const std::string& name) {
+            data_ = image::map_shm(name, O_RDWR, len_);
+            const auto* shm = header();
+            if (shm->magic.load(std::memory_order_acquire) != image::shm_magic ||
+                shm->key_kind  != static_cast<uint32_t>(image::key_kind<key_type>()) ||
+                shm->node_size != sizeof(image::node_t<key_type>) ||
+                shm->slot_offset + 2 * shm->slot_capacity > len_) {
+                ::munmap(data_, len_);
+                throw("Shared image does not match key type");
+            }
+        }
+        ~shared_tree_t() {
+            if (data_ != nullptr)
+                ::munmap(data_, len_);
+        }
+        shared_tree_t(const shared_tree_t& tree) = delete;
+        shared_tree_t& operator= (const shared_tree_t& tree) = delete;
+
+        // runs func(const image::view_t<key_type>&) on the current image, the view must
+        // not be kept after func returns
+        template<typename F>
+        auto read(F func) const {
+            auto* shm = header();
+            uint32_t idx = 0;
+            while (true) {
+                idx = shm->active.load();
+                shm->readers[idx].fetch_add(1);
+                if (shm->active.load() == idx)
+                    break;
+                shm->readers[idx].fetch_sub(1);   // switched meanwhile, pin the new one
+            }
+            struct unpin_t {
+                std::atomic<uint32_t>& readers;
+                ~unpin_t() {readers.fetch_sub(1);}
+            } unpin {shm->readers[idx]};
+
+            const char* slot = static_cast<const char*>(data_) + shm->slot_offset +
+                               idx * shm->slot_capacity;
+            const auto* image_header = reinterpret_cast<const image::header_t*>(slot);
+            image::view_t<key_type> view {slot, image::image_size<key_type>(image_header->count)};
+            return func(view);
+        }
+
+        size_t range_query(const key_type& l_bound, const key_type& u_bound) const {
+            return read([&](const auto& view) {return view.range_query(l_bound, u_bound);});
+        }
+        // smallest key >= key, nullopt if there is none
+        std::optional<key_type> lower_bound(const key_type& key) const {
+            return read([&](const auto& view) {
+                const key_type* found = view.lower_bound(key);
+                return found ? std::optional<key_type>(*found) : std::nullopt;
+            });
+        }
+        // largest key <= key, nullopt if there is none
+        std::optional<key_type> upper_bound(const key_type& key) const {
+            return read([&](const auto& view) {
+                const key_type* found = view.upper_bound(key);
+                return found ? std::optional<key_type>(*found) : std::nullopt;
+            });
+        }
+        size_t size() const {return read([](const auto& view) {return view.size();});};
+        uint64_t generation() const {return header()->generation.load();};
+};
+
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+//-----------------------------------------------------------------------------------------
+
+// Search tree over a key set known at compile time. The keys are sorted, duplicates are
+// dropped and the result is laid out in an array in breadth first order (node k has
+// children 2k and 2k + 1), so the tree is balanced and built by the compiler:
+//
+//  constexpr avl::static_tree_t bounds {std::array{10, 50, 100, 500}};
+//  static_assert(bounds.range_query(20, 100) == 2);
+//
+// lower_bound / upper_bound / range_query follow tree_t: lower_bound is the smallest key
+// >= key (the maximum if there is none), upper_bound is the largest key <= key (the
+// minimum if there is none).
+
+namespace avl {
+
+template<typename key_type, size_t N>
+class static_tree_t final {
+    static_assert(N > 0, "static tree needs at least one key");
+
+    std::array<key_type, N + 1> tree_ {}; // tree_[1] is the root, tree_[0] is not used
+    std::array<size_t,   N + 1> rank_ {}; // position of tree_[k] in sorted order
+    size_t size_ = 0;
+
+    constexpr void fill(const std::array<key_type, N>& sorted, size_t node, size_t& pos) {
+        if (node > size_)
+            return;
+        fill(sorted, 2 * node, pos);
+        tree_[node] = sorted[pos];
+        rank_[node] = pos++;
+        fill(sorted, 2 * node + 1, pos);
+    }
+
+    constexpr size_t lower_node(const key_type& key) const { // 0 if all keys < key
+        size_t found = 0;
+        for (size_t node = 1; node <= size_;) {
+            if (tree_[node] < key) {
+                node = 2 * node + 1;
+            }
+            else {
+                found = node;
+                node  = 2 * node;
+            }
+        }
+        return found;
+    }
+
+    constexpr size_t upper_node(const key_type& key) const { // 0 if all keys > key
+        size_t found = 0;
+        for (size_t node = 1; node <= size_;) {
+            if (key < tree_[node]) {
+                node = 2 * node;
+            }
+            else {
+                found = node;
+                node  = 2 * node + 1;
+            }
+        }
+        return found;
+    }
+
+    constexpr size_t leftmost() const {  // node of the minimum
+        size_t node = 1;
+        while (2 * node <= size_)
+            node *= 2;
+        return node;
+    }
+    constexpr size_t rightmost() const { // node of the maximum
+        size_t node = 1;
+        while (2 * node + 1 <= size_)
+            node = 2 * node + 1;
+        return node;
+    }
+
+    public:
+        constexpr explicit static_tree_t(const std::array<key_type, N>& keys) {
+            std::array<key_type, N> sorted = keys;
+            for (size_t i = 1; i < N; ++i) {   // std::sort is not constexpr before C++20
+                key_type key = sorted[i];
+                size_t j = i;
+                for (; j > 0 && key < sorted[j - 1]; --j)
+                    sorted[j] = sorted[j - 1];
+                sorted[j] = key;
+            }
+            for (size_t i = 0; i < N; ++i)
+                if (size_ == 0 || sorted[size_ - 1] < sorted[i])
+                    sorted[size_++] = sorted[i];
+
+            size_t pos = 0;
+            fill(sorted, 1, pos);
+        }
+
+        constexpr size_t size() const {return size_;};
+        constexpr bool contains(const key_type& key) const {
+            size_t node = lower_node(key);
+            return node != 0 && !(key < tree_[node]);
+        }
+
+        constexpr key_type lower_bound(const key_type& key) const {
+            size_t node = lower_node(key);
+            return node ? tree_[node] : tree_[rightmost()];
+        }
+        constexpr key_type upper_bound(const key_type& key) const {
+            size_t node = upper_node(key);
+            return node ? tree_[node] : tree_[leftmost()];
+        }
+
+        // number of keys < key
+        constexpr size_t rank(const key_type& key) const {
+            size_t node = lower_node(key);
+            return node ? rank_[node] : size_;
+        }
+        // number of keys in [l_bound, u_bound], 0 if l_bound is not less than u_bound
+        constexpr size_t range_query(const key_type& l_bound, const key_type& u_bound) const {
+            if (!(l_bound < u_bound))
+                return 0;
+            size_t node = upper_node(u_bound);
+            size_t num_not_greater = node ? rank_[node] + 1 : 0;
+            size_t num_less = rank(l_bound);
+            return num_not_greater > num_less ? num_not_greater - num_less : 0;
+        }
+};
+
+template<typename key_type, size_t N>
+static_tree_t(const std::array<key_type, N>&) -> static_tree_t<key_type, N>;
+}
@@ -0,0 +1,382 @@
+#pragma once
+
+#include "avl_tree.hpp"
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <limits>
+#include <stack>
+#include <string>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//-----------------------------------------------------------------------------------------
+
+// On-disk image of a tree_t: header_t followed by count nodes stored in in-order
+// position. Children are referenced by index, so the image is position independent
+// and the index of a node is also its rank (rank - 1).
+
+namespace avl {
+namespace image {
+
+constexpr uint64_t magic    = 0x0031474d494c5641; // "AVLIMG1"
+constexpr uint32_t version  = 1;
+constexpr uint32_t null_idx = std::numeric_limits<uint32_t>::max();
+
+enum class key_kind_t : uint32_t {
+    signed_int   = 0,
+    unsigned_int = 1,
+    floating     = 2,
+    raw          = 3
+};
+
+template<typename key_type>
+constexpr key_kind_t key_kind() {
+    if constexpr (std::is_floating_point_v<key_type>)
+        return key_kind_t::floating;
+    else if constexpr (std::is_integral_v<key_type> && std::is_signed_v<key_type>)
+        return key_kind_t::signed_int;
+    else if constexpr (std::is_integral_v<key_type>)
+        return key_kind_t::unsigned_int;
+    return key_kind_t::raw;
+}
+
+struct header_t {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t key_kind;
+    uint32_t key_size;
+    uint32_t node_size;
+    uint64_t count;
+    uint32_t root;
+    uint32_t reserved;
+    uint64_t checksum;   // FNV-1a of the node array
+};
+
+template<typename key_type>
+struct node_t {
+    key_type key;
+    uint32_t left;
+    uint32_t right;
+};
+
+//-----------------------------------------------------------------------------------------
+
+template<typename key_type>
+std::vector<node_t<key_type>> store_nodes(const tree_t<key_type>& tree) {
+    using src_node_t = avl::node_t<key_type>;
+
+    const src_node_t* root = tree.get_root();
+    std::vector<node_t<key_type>> nodes(tree.size());
+    if (root == nullptr)
+        return nodes;
+
+    // subtree -> first in-order index of that subtree
+    std::stack<std::pair<const src_node_t*, uint32_t>> node_stk;
+    node_stk.push({root, 0});
+    while (!node_stk.empty()) {
+        auto [cur_node, start] = node_stk.top();
+        node_stk.pop();
+
+        const auto& left  = cur_node->get_left();
+        const auto& right = cur_node->get_right();
+        uint32_t idx = start + cur_node->get_size(left);
+
+        nodes[idx].key   = cur_node->get_key();
+        nodes[idx].left  = null_idx;
+        nodes[idx].right = null_idx;
+        if (left != nullptr) {
+            nodes[idx].left = start + left->get_size(left->get_left());
+            node_stk.push({left.get(), start});
+        }
+        if (right != nullptr) {
+            nodes[idx].right = idx + 1 + right->get_size(right->get_left());
+            node_stk.push({right.get(), idx + 1});
+        }
+    }
+    return nodes;
+}
+
+template<typename key_type>
+header_t make_header(const tree_t<key_type>& tree, const std::vector<node_t<key_type>>& nodes) {
+    const avl::node_t<key_type>* root = tree.get_root();
+
+    header_t header {};
+    header.magic     = magic;
+    header.version   = version;
+    header.key_kind  = static_cast<uint32_t>(key_kind<key_type>());
+    header.key_size  = sizeof(key_type);
+    header.node_size = sizeof(node_t<key_type>);
+    header.count     = nodes.size();
+    header.root      = null_idx;
+    if (root != nullptr)
+        header.root = root->get_size(root->get_left());
+    header.checksum  = fnv1a_hash(nodes.data(), nodes.size() * sizeof(node_t<key_type>));
+    return header;
+}
+
+template<typename key_type>
+size_t image_size(size_t count) {
+    return sizeof(header_t) + count * sizeof(node_t<key_type>);
+}
+
+template<typename key_type>
+void write(const tree_t<key_type>& tree, const char* path) {
+    static_assert(std::is_trivially_copyable_v<key_type>,
+                  "image keys are written byte by byte");
+    if (tree.size() >= null_idx)
+        throw("Tree is too big for image");
+
+    std::vector<node_t<key_type>> nodes = store_nodes(tree);
+    header_t header = make_header(tree, nodes);
+
+    // a new file is written and renamed over the old one, so processes that have the
+    // old image mapped keep reading it
+    std::string tmp_path = std::string(path) + ".tmp";
+    FILE* file = std::fopen(tmp_path.c_str(), "wb");
+    if (file == nullptr)
+        throw("Can not open image file");
+
+    bool is_written =
+        std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+        (nodes.empty() ||
+         std::fwrite(nodes.data(), sizeof(node_t<key_type>), nodes.size(), file) == nodes.size());
+    is_written = (std::fflush(file) == 0) && (::fsync(::fileno(file)) == 0) && is_written;
+    std::fclose(file);
+    if (!is_written || std::rename(tmp_path.c_str(), path) != 0) {
+        std::remove(tmp_path.c_str());
+        throw("Can not write image file");
+    }
+}
+
+//-----------------------------------------------------------------------------------------
+
+template<typename key_type = int>
+class view_t {
+    protected:
+        const header_t* header_ = nullptr;
+        const node_t<key_type>* nodes_ = nullptr;
+
+    public:
+        view_t() {};
+        // check_nodes - run verify_nodes(), it reads every node. Without it a descent still
+        // checks every child index and throws on a corrupted one.
+        view_t(const void* data, size_t len, bool check_nodes = false) {
+            if (len < sizeof(header_t))
+                throw("Image is too short");
+
+            header_ = static_cast<const header_t*>(data);
+            if (header_->magic    != magic || header_->version  != version  ||
+                header_->key_kind != static_cast<uint32_t>(key_kind<key_type>()) ||
+                header_->key_size != sizeof(key_type) ||
+                header_->node_size != sizeof(node_t<key_type>))
+                throw("Image does not match key type");
+
+            if (len != image_size<key_type>(header_->count))
+                throw("Image is truncated");
+            if (header_->count >= null_idx ||
+                (header_->count == 0) != (header_->root == null_idx) ||
+                (header_->count != 0 && header_->root >= header_->count))
+                throw("Image is corrupted");
+
+            nodes_ = reinterpret_cast<const node_t<key_type>*>(
+                                        static_cast<const char*>(data) + sizeof(header_t));
+            if (check_nodes && !verify_nodes())
+                throw("Image is corrupted");
+        }
+
+        size_t size() const {return header_ ? header_->count : 0;};
+        key_type const & key_at(size_t idx) const {return nodes_[idx].key;};
+
+        bool verify_checksum() const {
+            return fnv1a_hash(nodes_, size() * sizeof(node_t<key_type>)) == header_->checksum;
+        }
+        bool verify_nodes() const;
+
+        size_t rank_lower(const key_type& key) const; // first index with key >= key
+        size_t rank_upper(const key_type& key) const; // first index with key >  key
+
+        const key_type* lower_bound(const key_type& key) const;
+        const key_type* upper_bound(const key_type& key) const;
+        size_t range_query(const key_type& l_bound, const key_type& u_bound) const;
+
+        template<typename F>
+        void inorder_walk(const key_type& l_bound, const key_type& u_bound, F func) const;
+        std::vector<key_type> store_inorder_walk() const;
+};
+
+//-----------------------------------------------------------------------------------------
+
+// every subtree must hold exactly the nodes of an index interval with its root inside,
+// so children stay in [0, count) and no descent can loop
+template<typename key_type>
+bool view_t<key_type>::verify_nodes() const {
+    size_t count = size();
+    if (count == 0)
+        return true;
+
+    struct subtree_t {uint32_t idx; uint32_t lo; uint32_t hi;}; // idx in [lo, hi)
+    std::stack<subtree_t> subtree_stk;
+    subtree_stk.push({header_->root, 0, static_cast<uint32_t>(count)});
+    while (!subtree_stk.empty()) {
+        subtree_t cur = subtree_stk.top();
+        subtree_stk.pop();
+        if (cur.idx < cur.lo || cur.idx >= cur.hi)
+            return false;
+
+        uint32_t left  = nodes_[cur.idx].left;
+        uint32_t right = nodes_[cur.idx].right;
+        if ((left == null_idx) != (cur.idx == cur.lo) ||
+            (right == null_idx) != (cur.idx + 1 == cur.hi))
+            return false;
+        if (left != null_idx)
+            subtree_stk.push({left, cur.lo, cur.idx});
+        if (right != null_idx)
+            subtree_stk.push({right, cur.idx + 1, cur.hi});
+    }
+    return true;
+}
+
+// The subtree of a node in in-order position idx lies in [lo, hi) and the children are
+// in [lo, idx) and [idx + 1, hi), an index out of this interval means a corrupted image.
+// The interval shrinks at every step, so a descent can not loop.
+template<typename key_type>
+size_t view_t<key_type>::rank_lower(const key_type& key) const {
+    size_t   rank = size();
+    uint32_t idx  = size() ? header_->root : null_idx;
+    size_t   lo = 0, hi = size();
+    while (idx != null_idx) {
+        if (idx < lo || idx >= hi)
+            throw("Image is corrupted");
+        const node_t<key_type>& cur_node = nodes_[idx];
+        if (cur_node.key < key) {
+            lo  = idx + 1;
+            idx = cur_node.right;
+        }
+        else {
+            rank = idx;
+            hi   = idx;
+            idx  = cur_node.left;
+        }
+    }
+    return rank;
+}
+
+template<typename key_type>
+size_t view_t<key_type>::rank_upper(const key_type& key) const {
+    size_t   rank = size();
+    uint32_t idx  = size() ? header_->root : null_idx;
+    size_t   lo = 0, hi = size();
+    while (idx != null_idx) {
+        if (idx < lo || idx >= hi)
+            throw("Image is corrupted");
+        const node_t<key_type>& cur_node = nodes_[idx];
+        if (key < cur_node.key) {
+            rank = idx;
+            hi   = idx;
+            idx  = cur_node.left;
+        }
+        else {
+            lo  = idx + 1;
+            idx = cur_node.right;
+        }
+    }
+    return rank;
+}
+
+template<typename key_type>
+const key_type* view_t<key_type>::lower_bound(const key_type& key) const {
+    size_t rank = rank_lower(key);
+    if (rank == size())
+        return nullptr;
+    return &nodes_[rank].key;
+}
+
+template<typename key_type>
+const key_type* view_t<key_type>::upper_bound(const key_type& key) const {
+    size_t rank = rank_upper(key);
+    if (rank == 0)
+        return nullptr;
+    return &nodes_[rank - 1].key;
+}
+
+template<typename key_type>
+size_t view_t<key_type>::range_query(const key_type& l_bound, const key_type& u_bound) const {
+    if (!(l_bound < u_bound) || size() == 0) {
+        return 0;
+    }
+    return rank_upper(u_bound) - rank_lower(l_bound);
+}
+
+template<typename key_type>
+template<typename F>
+void view_t<key_type>::inorder_walk(const key_type& l_bound, const key_type& u_bound,
+                                    F func) const {
+    for (size_t idx = rank_lower(l_bound); idx < size() && !(u_bound < nodes_[idx].key); ++idx)
+        func(nodes_[idx].key);
+}
+
+template<typename key_type>
+std::vector<key_type> view_t<key_type>::store_inorder_walk() const {
+    std::vector<key_type> storage;
+    storage.reserve(size());
+    for (size_t idx = 0; idx < size(); ++idx)
+        storage.push_back(nodes_[idx].key);
+    return storage;
+}
+
+}
+
+//-----------------------------------------------------------------------------------------
+
+// Read-only tree served straight from a mmap-ed image file.
+template<typename key_type = int>
+class mapped_tree_t final : public image::view_t<key_type> {
+    void*  data_ = nullptr;
+    size_t len_  = 0;
+
+    public:
+        // check_nodes - verify_nodes() on open, it reads the whole image
+        mapped_tree_t(const char* path, bool check_nodes = false) {
+            int fd = open(path, O_RDONLY);
+            if (fd < 0)
+                throw("Can not open image file");
+
+            struct stat st {};
+            if (fstat(fd, &st) != 0) {
+                close(fd);
+                throw("Can not stat image file");
+            }
+            len_  = static_cast<size_t>(st.st_size);
+            data_ = mmap(nullptr, len_, PROT_READ, MAP_SHARED, fd, 0);
+            close(fd);
+            if (data_ == MAP_FAILED) {
+                data_ = nullptr;
+                throw("Can not map image file");
+            }
+
+            try {
+                static_cast<image::view_t<key_type>&>(*this) =
+                    image::view_t<key_type>(data_, len_, check_nodes);
+            }
+            catch (...) {
+                munmap(data_, len_);
+                throw;
+            }
+        }
+        ~mapped_tree_t() {
+            if (data_ != nullptr)
+                munmap(data_, len_);
+        }
+
+        mapped_tree_t(const mapped_tree_t<key_type>& tree) = delete;
+        mapped_tree_t<key_type>& operator= (const mapped_tree_t<key_type>& tree) = delete;
+        mapped_tree_t(mapped_tree_t<key_type>&& tree) :
+            image::view_t<key_type>(tree),
+            data_(std::exchange(tree.data_, nullptr)),
+            len_ (std::exchange(tree.len_,  0)) {};
+};
+}
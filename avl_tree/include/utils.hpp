@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <cmath>
+#include <cstdint>
 #include "debug_utils.hpp"
 
 //-----------------------------------------------------------------------------------------
@@ -17,6 +18,16 @@ static bool in_interval(const int l_bound, const int u_bound, const int val) {
     return false;
 }
 
+inline uint64_t fnv1a_hash(const void* data, size_t len) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = 0xcbf29ce484222325;
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
 struct test__ {
     int val = 10;
     test__ (int v) {
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "avl_tree.hpp"
+#include <chrono>
+#include <vector>
+
+//-----------------------------------------------------------------------------------------
+
+// Sliding window over a stream of keys: only the last max_events keys and the keys not
+// older than max_age are counted by range_query. Events are kept in insertion order in a
+// ring of max_events slots, so memory does not grow with the length of the stream, and
+// every expired event costs one O(log(n)) erase of a copy from the multiset.
+//
+// Age expiry is checked every expire_every insertions (a batch of old events goes at
+// once) and always before a query, so answers are exact for the time of the query.
+// Times of events must not decrease.
+
+namespace avl {
+
+template<typename key_type = int, typename clock_type = std::chrono::steady_clock,
+         typename balance_type = balance::avl_t>
+class window_tree_t final {
+    public:
+        using time_point = typename clock_type::time_point;
+        using duration   = typename clock_type::duration;
+
+    private:
+        struct event_t {
+            key_type   key;
+            time_point time;
+        };
+
+        multiset_t<key_type, balance_type> tree_;
+        std::vector<event_t> events_;  // ring, events_[head_] is the oldest event
+        size_t head_ = 0;
+        size_t size_ = 0;
+
+        duration max_age_;
+        size_t expire_every_;
+        size_t since_expire_ = 0;
+
+        void evict_oldest() {
+            tree_.erase_one(events_[head_].key);
+            if (++head_ == events_.size())
+                head_ = 0;
+            --size_;
+        }
+        const event_t& newest() const {
+            size_t tail = head_ + size_ - 1;
+            return events_[tail < events_.size() ? tail : tail - events_.size()];
+        }
+
+    public:
+        explicit window_tree_t(size_t max_events, duration max_age = duration::max(),
+                               size_t expire_every = 1) :
+            events_(max_events),
+            max_age_(max_age),
+            expire_every_(expire_every ? expire_every : 1) {
+            if (max_events == 0)
+                throw("Window must hold at least one event");
+        }
+
+        void insert(const key_type& key, time_point now = clock_type::now()) {
+            if (size_ > 0 && now < newest().time)
+                throw("Events of window must come in time order");
+            if (size_ == events_.size())
+                evict_oldest();
+
+            size_t tail = head_ + size_;
+            events_[tail < events_.size() ? tail : tail - events_.size()] = {key, now};
+            ++size_;
+            tree_.insert(key);
+
+            if (++since_expire_ >= expire_every_)
+                expire(now);
+        }
+
+        // evicts events older than max_age, returns their number
+        size_t expire(time_point now = clock_type::now()) {
+            since_expire_ = 0;
+            if (max_age_ == duration::max())
+                return 0;
+            size_t num = 0;
+            for (; size_ > 0 && now - events_[head_].time > max_age_; ++num)
+                evict_oldest();
+            return num;
+        }
+
+        // number of keys in [l_bound, u_bound] among the events of the window at now
+        size_t range_query(const key_type& l_bound, const key_type& u_bound,
+                           time_point now = clock_type::now()) {
+            expire(now);
+            return tree_.range_query(l_bound, u_bound);
+        }
+
+        size_t size()       const {return size_;};
+        size_t max_events() const {return events_.size();};
+        duration max_age()  const {return max_age_;};
+        const multiset_t<key_type, balance_type>& keys() const {return tree_;};
+};
+
+}
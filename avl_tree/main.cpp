@@ -2,16 +2,33 @@
 
 //-----------------------------------------------------------------------------------------
 
-int main() {
+// avl_tree [--pipelined] [--latency]
+//  --pipelined - parse, run the tree and print on separate threads, output is the same
+//  --latency   - time every insert and range_query, percentiles go to stderr at exit
+int main(int argc, char* argv[]) {
     using namespace avl_tree_ui;
+    bool is_pipelined = false;
+    bool is_timed     = false;
+    for (int idx = 1; idx < argc; ++idx) {
+        is_pipelined |= (std::string(argv[idx]) == "--pipelined");
+        is_timed     |= (std::string(argv[idx]) == "--latency");
+    }
+
+    time_control::latency_recorder_t recorder {tree_op_names()};
+    time_control::latency_recorder_t* latency = is_timed ? &recorder : nullptr;
 
     auto tree_start_time = time_control::chrono_cur_time ();
-    avl_tree_ui::run_tree();
+    if (is_pipelined)
+        avl_tree_ui::run_tree_pipelined(std::cin, latency);
+    else
+        avl_tree_ui::run_tree(std::cin, latency);
     auto tree_end_time = time_control::chrono_cur_time ();
 
     std::clog << "----------------------------------------------\n";
     std::clog << "Total tree run time: " << (tree_end_time - tree_start_time) / 0.1ms
     << " * 10^(-5) sec\n";
+    if (is_timed)
+        recorder.report(std::clog);
 
     return 0;
 }
@@ -0,0 +1,154 @@
+#include "time_control.hpp"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <algorithm>
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+//-----------------------------------------------------------------------------------------
+
+// Load generator for avl_server:
+//  avl_load [socket_path] [clients] [commands_per_client] [pipeline_depth] [insert_percent]
+// Every client sends its commands in batches of pipeline_depth and waits for the answers
+// of the batch. Latency of a query is the time from sending its batch to reading its
+// answer. Prints throughput (commands per second) and query latency percentiles.
+
+namespace {
+
+using namespace time_control;
+
+struct config_t {
+    std::string path  = "/tmp/avl_tree.sock";
+    size_t clients    = 4;
+    size_t commands   = 200'000;
+    size_t depth      = 64;
+    size_t insert_pct = 10;
+};
+
+int connect_to(const std::string& path) {
+    sockaddr_un addr {};
+    addr.sun_family = AF_UNIX;
+    std::copy(path.begin(), path.end(), addr.sun_path);
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+        throw("Can not connect to server");
+    return fd;
+}
+
+void write_all(int fd, const std::string& data) {
+    size_t done = 0;
+    while (done < data.size()) {
+        ssize_t num = ::write(fd, data.data() + done, data.size() - done);
+        if (num < 0 && errno == EINTR)
+            continue;
+        if (num <= 0)
+            throw("Can not write to server");
+        done += static_cast<size_t>(num);
+    }
+}
+
+// latencies of answered queries in microseconds
+std::vector<double> run_client(const config_t& config, unsigned seed) {
+    int fd = connect_to(config.path);
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> key_dist(-1'000'000, 1'000'000);
+    std::uniform_int_distribution<int> width_dist(0, 20'000);
+    std::uniform_int_distribution<size_t> pct_dist(0, 99);
+
+    std::vector<double> latencies;
+    std::string batch;
+    char buf[1 << 16];
+    for (size_t done = 0; done < config.commands; done += config.depth) {
+        batch.clear();
+        size_t num_of_queries = 0;
+        for (size_t idx = 0; idx < config.depth && done + idx < config.commands; ++idx) {
+            int key = key_dist(gen);
+            if (pct_dist(gen) < config.insert_pct) {
+                batch += "k " + std::to_string(key) + '\n';
+            }
+            else {
+                batch += "q " + std::to_string(key) + ' ' +
+                         std::to_string(key + width_dist(gen)) + '\n';
+                ++num_of_queries;
+            }
+        }
+
+        auto start_time = chrono_cur_time();
+        write_all(fd, batch);
+        while (num_of_queries > 0) {
+            ssize_t num = ::read(fd, buf, sizeof(buf));
+            if (num < 0 && errno == EINTR)
+                continue;
+            if (num <= 0)
+                throw("Server closed connection");
+            double latency = (chrono_cur_time() - start_time) / 1.0us;
+            size_t answers = std::count(buf, buf + num, '\n');
+            latencies.insert(latencies.end(), answers, latency);
+            num_of_queries -= std::min(answers, num_of_queries);
+        }
+    }
+    ::close(fd);
+    return latencies;
+}
+
+double percentile(const std::vector<double>& sorted, double share) {
+    if (sorted.empty())
+        return 0;
+    return sorted[std::min(sorted.size() - 1, static_cast<size_t>(share * sorted.size()))];
+}
+
+}
+
+//-----------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    config_t config;
+    if (argc > 1) config.path       = argv[1];
+    if (argc > 2) config.clients    = std::stoul(argv[2]);
+    if (argc > 3) config.commands   = std::stoul(argv[3]);
+    if (argc > 4) config.depth      = std::max<size_t>(1, std::stoul(argv[4]));
+    if (argc > 5) config.insert_pct = std::stoul(argv[5]);
+
+    std::vector<std::vector<double>> latencies(config.clients);
+    std::atomic<bool> is_failed = false;
+    auto start_time = chrono_cur_time();
+    std::vector<std::thread> clients;
+    for (size_t idx = 0; idx < config.clients; ++idx)
+        clients.emplace_back([&, idx] {
+            try {
+                latencies[idx] = run_client(config, static_cast<unsigned>(idx + 1));
+            }
+            catch (const char* error) {
+                std::cerr << error << '\n';
+                is_failed = true;
+            }
+        });
+    for (auto& client : clients)
+        client.join();
+    double seconds = (chrono_cur_time() - start_time) / 1.0s;
+    if (is_failed)
+        return 1;
+
+    std::vector<double> all;
+    for (const auto& client : latencies)
+        all.insert(all.end(), client.begin(), client.end());
+    std::sort(all.begin(), all.end());
+
+    double total = double(config.clients * config.commands);
+    std::cout << std::fixed << std::setprecision(1)
+              << "clients: " << config.clients << ", depth: " << config.depth
+              << ", inserts: " << config.insert_pct << "%\n"
+              << "qps:     " << total / seconds << '\n'
+              << "p50 us:  " << percentile(all, 0.50) << '\n'
+              << "p99 us:  " << percentile(all, 0.99) << '\n'
+              << "max us:  " << (all.empty() ? 0 : all.back()) << '\n';
+    return 0;
+}
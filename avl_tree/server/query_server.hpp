@@ -0,0 +1,342 @@
+#pragma once
+
+#include "avl_tree.hpp"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <charconv>
+#include <cerrno>
+#include <cctype>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+//-----------------------------------------------------------------------------------------
+
+// Long running range query server: one tree_t stays resident and serves the commands of
+// run_tree ("k key", "q l_bound u_bound") from many local clients over a Unix domain
+// socket. A client may send any number of commands without waiting for answers, answers
+// to its queries come back in order, one number per line.
+//
+// One epoll loop does all the work. In every round inserts are collected and applied in
+// sorted order right before the next query, and queries in a row (of all clients) are
+// answered by one range_query_batch.
+
+namespace avl_server {
+
+class query_server_t final {
+    struct client_t {
+        std::string in;               // bytes of incomplete commands
+        std::string out;              // answers not sent yet
+        size_t      sent      = 0;
+        uint32_t    events    = 0;
+        bool        is_closed = false; // client has shut down its side
+    };
+
+    struct query_t {
+        int fd;
+        std::pair<int, int> bounds;
+    };
+
+    static constexpr size_t read_size  = 1 << 16;
+    static constexpr size_t max_unsent = 1 << 22; // stop reading a client above it
+    static constexpr int    max_events = 64;
+
+    avl::tree_t<int> tree_;
+    std::string path_;
+    int listen_fd_ = -1;
+    int epoll_fd_  = -1;
+    int stop_fd_   = -1;
+
+    std::unordered_map<int, client_t> clients_;
+    std::vector<int>     keys_;    // inserts not applied yet
+    std::vector<query_t> queries_; // queries not answered yet
+
+    void add_fd(int fd, uint32_t events);
+    void accept_clients();
+    void read_client(int fd, client_t& client);
+    enum class num_state_t {ok, incomplete, malformed};
+    static num_state_t read_num(const std::string& in, size_t& pos, int& num);
+    void parse(int fd, client_t& client);
+    void send_client(int fd, client_t& client);
+    void update_events(int fd, client_t& client);
+    void close_client(int fd);
+    void close_all();
+
+    void flush_keys();
+    void flush_queries();
+
+    public:
+        explicit query_server_t(const std::string& path);
+        ~query_server_t();
+
+        query_server_t(const query_server_t& server) = delete;
+        query_server_t& operator= (const query_server_t& server) = delete;
+
+        void run();
+        void stop();   // may be called from any thread
+
+        const avl::tree_t<int>& tree() const {return tree_;};
+};
+
+//-----------------------------------------------------------------------------------------
+
+inline query_server_t::query_server_t(const std::string& path) : path_(path) {
+    sockaddr_un addr {};
+    if (path_.size() >= sizeof(addr.sun_path))
+        throw("Socket path is too long");
+    addr.sun_family = AF_UNIX;
+    std::copy(path_.begin(), path_.end(), addr.sun_path);
+
+    listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    epoll_fd_  = ::epoll_create1(EPOLL_CLOEXEC);
+    stop_fd_   = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (listen_fd_ < 0 || epoll_fd_ < 0 || stop_fd_ < 0) {
+        close_all();
+        throw("Can not create server socket");
+    }
+
+    ::unlink(path_.c_str());  // socket left by a previous run
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listen_fd_, SOMAXCONN) != 0) {
+        close_all();
+        throw("Can not bind server socket");
+    }
+    add_fd(listen_fd_, EPOLLIN);
+    add_fd(stop_fd_,   EPOLLIN);
+}
+
+inline query_server_t::~query_server_t() {
+    close_all();
+}
+
+inline void query_server_t::close_all() {
+    for (auto& [fd, client] : clients_)
+        ::close(fd);
+    clients_.clear();
+    for (int* fd : {&listen_fd_, &epoll_fd_, &stop_fd_}) {
+        if (*fd >= 0)
+            ::close(*fd);
+        *fd = -1;
+    }
+    ::unlink(path_.c_str());
+}
+
+inline void query_server_t::stop() {
+    uint64_t one = 1;
+    if (::write(stop_fd_, &one, sizeof(one)) < 0)
+        throw("Can not stop server");
+}
+
+inline void query_server_t::add_fd(int fd, uint32_t events) {
+    epoll_event event {};
+    event.events  = events;
+    event.data.fd = fd;
+    if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) != 0)
+        throw("Can not watch socket");
+}
+
+//-----------------------------------------------------------------------------------------
+
+inline void query_server_t::run() {
+    epoll_event events[max_events];
+    while (true) {
+        int num = ::epoll_wait(epoll_fd_, events, max_events, -1);
+        if (num < 0) {
+            if (errno == EINTR)
+                continue;
+            throw("Can not wait for sockets");
+        }
+
+        for (int idx = 0; idx < num; ++idx) {
+            int fd = events[idx].data.fd;
+            if (fd == stop_fd_)
+                return;
+            if (fd == listen_fd_) {
+                accept_clients();
+                continue;
+            }
+            auto client = clients_.find(fd);
+            if (client == clients_.end())
+                continue;
+            if (events[idx].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+                read_client(fd, client->second);
+        }
+
+        // the round ends with every command applied, so answers can be sent
+        flush_keys();
+        flush_queries();
+        std::vector<int> fds;
+        for (auto& [fd, client] : clients_)
+            fds.push_back(fd);
+        for (int fd : fds)
+            send_client(fd, clients_[fd]);
+    }
+}
+
+inline void query_server_t::accept_clients() {
+    while (true) {
+        int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR)
+                continue;
+            return;  // EAGAIN or a client gone before accept
+        }
+        client_t& client = clients_[fd];
+        client.events = EPOLLIN;
+        add_fd(fd, client.events);
+    }
+}
+
+inline void query_server_t::read_client(int fd, client_t& client) {
+    if (client.is_closed)
+        return;
+    size_t old_size = client.in.size();
+    client.in.resize(old_size + read_size);
+    ssize_t num = ::read(fd, client.in.data() + old_size, read_size);
+    client.in.resize(old_size + std::max<ssize_t>(num, 0));
+
+    if (num < 0 && (errno == EAGAIN || errno == EINTR))
+        return;
+    if (num <= 0) {
+        client.is_closed = true;  // the last command may end without a separator
+        client.in.push_back('\n');
+    }
+    parse(fd, client);
+}
+
+// a number is complete when it is followed by a separator
+inline query_server_t::num_state_t query_server_t::read_num(const std::string& in, size_t& pos,
+                                                            int& num) {
+    while (pos < in.size() && std::isspace(static_cast<unsigned char>(in[pos])))
+        ++pos;
+    if (pos + 1 == in.size() && in[pos] == '-')  // the digits are in the next read
+        return num_state_t::incomplete;
+    auto [end, err] = std::from_chars(in.data() + pos, in.data() + in.size(), num);
+    if (end == in.data() + in.size())
+        return num_state_t::incomplete;
+    if (err != std::errc()) {
+        pos = end - in.data();  // the bad character is skipped by parse
+        return num_state_t::malformed;
+    }
+    pos = end - in.data();
+    return num_state_t::ok;
+}
+
+// takes complete commands from the input of a client, unknown characters and commands
+// with malformed numbers are skipped like run_tree does
+inline void query_server_t::parse(int fd, client_t& client) {
+    const std::string& in = client.in;
+    size_t pos = 0;
+    while (pos < in.size()) {
+        size_t start = pos;
+        char type = in[pos++];
+        if (type != 'k' && type != 'q')
+            continue;
+
+        int nums[2] = {};
+        size_t num_of_nums = (type == 'k') ? 1 : 2;
+        num_state_t state = num_state_t::ok;
+        for (size_t idx = 0; idx < num_of_nums && state == num_state_t::ok; ++idx)
+            state = read_num(in, pos, nums[idx]);
+        if (state == num_state_t::incomplete) {
+            pos = start;
+            break;
+        }
+        if (state == num_state_t::malformed)
+            continue;
+
+        if (type == 'k') {
+            flush_queries();
+            keys_.push_back(nums[0]);
+        }
+        else {
+            flush_keys();
+            queries_.push_back({fd, {nums[0], nums[1]}});
+        }
+    }
+    client.in.erase(0, pos);
+}
+
+//-----------------------------------------------------------------------------------------
+
+inline void query_server_t::flush_keys() {
+    if (keys_.empty())
+        return;
+    std::sort(keys_.begin(), keys_.end()); // sorted keys go through finger insertion
+    for (int key : keys_)
+        tree_.insert(key);
+    keys_.clear();
+}
+
+inline void query_server_t::flush_queries() {
+    if (queries_.empty())
+        return;
+    std::vector<std::pair<int, int>> bounds;
+    bounds.reserve(queries_.size());
+    for (const auto& query : queries_)
+        bounds.push_back(query.bounds);
+
+    std::vector<size_t> answers = tree_.range_query_batch(bounds);
+    char buf[24];
+    for (size_t idx = 0; idx < answers.size(); ++idx) {
+        auto [end, err] = std::to_chars(buf, buf + sizeof(buf) - 1, answers[idx]);
+        *end++ = '\n';
+        clients_[queries_[idx].fd].out.append(buf, end);
+    }
+    queries_.clear();
+}
+
+//-----------------------------------------------------------------------------------------
+
+inline void query_server_t::send_client(int fd, client_t& client) {
+    while (client.sent < client.out.size()) {
+        ssize_t num = ::send(fd, client.out.data() + client.sent, client.out.size() - client.sent,
+                             MSG_NOSIGNAL);
+        if (num < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN)
+                break;
+            close_client(fd);  // client is gone, its answers are dropped
+            return;
+        }
+        client.sent += static_cast<size_t>(num);
+    }
+    if (client.sent == client.out.size()) {
+        client.out.clear();
+        client.sent = 0;
+        if (client.is_closed) {
+            close_client(fd);
+            return;
+        }
+    }
+    update_events(fd, client);
+}
+
+inline void query_server_t::update_events(int fd, client_t& client) {
+    size_t unsent = client.out.size() - client.sent;
+    uint32_t events = 0;
+    if (!client.is_closed && unsent < max_unsent)
+        events |= EPOLLIN;
+    if (unsent > 0)
+        events |= EPOLLOUT;
+    if (events == client.events)
+        return;
+
+    epoll_event event {};
+    event.events  = events;
+    event.data.fd = fd;
+    if (::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event) != 0)
+        throw("Can not watch socket");
+    client.events = events;
+}
+
+inline void query_server_t::close_client(int fd) {
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    clients_.erase(fd);
+}
+}
@@ -0,0 +1,37 @@
+#include "query_server.hpp"
+#include <csignal>
+#include <thread>
+
+//-----------------------------------------------------------------------------------------
+
+// avl_server [socket_path] - serves "k key" / "q l_bound u_bound" commands until SIGINT
+// or SIGTERM
+
+int main(int argc, char* argv[]) {
+    const char* path = (argc > 1) ? argv[1] : "/tmp/avl_tree.sock";
+
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    try {
+        avl_server::query_server_t server {path};
+        std::thread waiter([&] {
+            int signal = 0;
+            sigwait(&signals, &signal);
+            server.stop();
+        });
+        waiter.detach();
+
+        std::clog << "Serving on " << path << '\n';
+        server.run();
+        std::clog << "Stopped, keys in tree: " << server.tree().size() << '\n';
+    }
+    catch (const char* error) {
+        std::cerr << error << '\n';
+        return 1;
+    }
+    return 0;
+}
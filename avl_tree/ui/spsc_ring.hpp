@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <thread>
+
+//-----------------------------------------------------------------------------------------
+
+// Lock-free ring for one producer thread and one consumer thread. Head and tail live in
+// different cache lines, a full (empty) ring makes the producer (consumer) yield.
+
+namespace avl_tree_ui {
+
+template<typename T, size_t capacity>
+class spsc_ring_t final {
+    static_assert(capacity > 0 && (capacity & (capacity - 1)) == 0,
+                  "capacity must be a power of two");
+    static constexpr size_t mask = capacity - 1;
+
+    std::array<T, capacity> slots_;
+    alignas(64) std::atomic<size_t> head_ {0};  // next slot to pop, written by consumer
+    alignas(64) std::atomic<size_t> tail_ {0};  // next slot to push, written by producer
+
+    public:
+        bool try_push(T& item) {
+            size_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail - head_.load(std::memory_order_acquire) == capacity)
+                return false;
+            slots_[tail & mask] = std::move(item);
+            tail_.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool try_pop(T& item) {
+            size_t head = head_.load(std::memory_order_relaxed);
+            if (head == tail_.load(std::memory_order_acquire))
+                return false;
+            item = std::move(slots_[head & mask]);
+            head_.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        void push(T&& item) {
+            while (!try_push(item))
+                std::this_thread::yield();
+        }
+
+        T pop() {
+            T item;
+            while (!try_pop(item))
+                std::this_thread::yield();
+            return item;
+        }
+};
+}
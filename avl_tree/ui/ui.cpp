@@ -1,11 +1,15 @@
 #include "./ui.hpp"
+#include "./spsc_ring.hpp"
+#include <charconv>
+#include <iomanip>
+#include <thread>
 
 //-----------------------------------------------------------------------------------------
 
 namespace avl_tree_ui {
 
-void run_tree(std::istream & in_strm) {
-    avl::tree_t<int> pine;
+void run_tree(std::istream & in_strm, latency_recorder_t* latency) {
+    default_tree_t<int> pine;
     char type_of_data = '\0';
     int data    = 0;
     int l_bound = 0;
@@ -16,17 +20,176 @@ void run_tree(std::istream & in_strm) {
         in_strm >> type_of_data;
         if (type_of_data == 'k') {
             in_strm >> data;
-            pine.emplace(data);
+            if (latency)
+                latency->measure(op_insert, [&] {pine.emplace(data);});
+            else
+                pine.emplace(data);
         }
         else if (type_of_data == 'q') {
             in_strm >> l_bound >> u_bound;
-            std::cout << pine.range_query(l_bound, u_bound) << ' ';
+            size_t answer = latency ?
+                latency->measure(op_range_query, [&] {return pine.range_query(l_bound, u_bound);}) :
+                pine.range_query(l_bound, u_bound);
+            std::cout << answer << ' ';
         }
         type_of_data = '\0';
     }
     std::cout << std::endl;
 }
 
+//-----------------------------------------------------------------------------------------
+
+namespace {
+
+struct command_t {
+    char type;
+    int  l_bound;  // key of 'k'
+    int  u_bound;
+};
+
+struct command_batch_t {
+    std::vector<command_t> commands;
+    bool is_last = false;
+};
+
+struct answer_batch_t {
+    std::vector<size_t> answers;
+    bool is_last = false;
+};
+
+struct stage_stat_t {
+    const char* name;
+    size_t items    = 0;
+    double total_ms = 0;
+    double wait_ms  = 0;  // blocked on a ring
+};
+
+constexpr size_t pipeline_batch = 4096;
+constexpr size_t pipeline_ring  = 64;
+
+using command_ring_t = spsc_ring_t<command_batch_t, pipeline_ring>;
+using answer_ring_t  = spsc_ring_t<answer_batch_t,  pipeline_ring>;
+
+template<typename F>
+void measure_wait(stage_stat_t& stat, F&& func) {
+    auto start_time = chrono_cur_time();
+    func();
+    stat.wait_ms += (chrono_cur_time() - start_time) / 1.0ms;
+}
+
+// reads the input exactly like run_tree does
+void parse_stage(std::istream& in_strm, command_ring_t& commands, stage_stat_t& stat) {
+    auto start_time = chrono_cur_time();
+    char type_of_data = '\0';
+    int data    = 0;
+    int l_bound = 0;
+    int u_bound = 0;
+
+    command_batch_t batch;
+    batch.commands.reserve(pipeline_batch);
+    while(!in_strm.eof()) {
+        in_strm >> type_of_data;
+        if (type_of_data == 'k') {
+            in_strm >> data;
+            batch.commands.push_back({'k', data, 0});
+        }
+        else if (type_of_data == 'q') {
+            in_strm >> l_bound >> u_bound;
+            batch.commands.push_back({'q', l_bound, u_bound});
+        }
+        type_of_data = '\0';
+
+        if (batch.commands.size() == pipeline_batch) {
+            stat.items += batch.commands.size();
+            measure_wait(stat, [&] {commands.push(std::move(batch));});
+            batch = {};
+            batch.commands.reserve(pipeline_batch);
+        }
+    }
+    stat.items += batch.commands.size();
+    batch.is_last = true;
+    measure_wait(stat, [&] {commands.push(std::move(batch));});
+    stat.total_ms = (chrono_cur_time() - start_time) / 1.0ms;
+}
+
+void execute_stage(command_ring_t& commands, answer_ring_t& answers, stage_stat_t& stat,
+                   latency_recorder_t* latency) {
+    auto start_time = chrono_cur_time();
+    default_tree_t<int> pine;
+    for (bool is_last = false; !is_last;) {
+        command_batch_t batch;
+        measure_wait(stat, [&] {batch = commands.pop();});
+        is_last = batch.is_last;
+
+        answer_batch_t result;
+        result.is_last = is_last;
+        for (const auto& command : batch.commands) {
+            if (command.type == 'k') {
+                if (latency)
+                    latency->measure(op_insert, [&] {pine.emplace(command.l_bound);});
+                else
+                    pine.emplace(command.l_bound);
+                continue;
+            }
+            auto query = [&] {return pine.range_query(command.l_bound, command.u_bound);};
+            result.answers.push_back(latency ? latency->measure(op_range_query, query) : query());
+        }
+        stat.items += batch.commands.size();
+        if (!result.answers.empty() || is_last)
+            measure_wait(stat, [&] {answers.push(std::move(result));});
+    }
+    stat.total_ms = (chrono_cur_time() - start_time) / 1.0ms;
+}
+
+void format_stage(answer_ring_t& answers, stage_stat_t& stat) {
+    auto start_time = chrono_cur_time();
+    std::string text;
+    char buf[24];
+    for (bool is_last = false; !is_last;) {
+        answer_batch_t batch;
+        measure_wait(stat, [&] {batch = answers.pop();});
+        is_last = batch.is_last;
+
+        text.clear();
+        for (size_t answer : batch.answers) {
+            char* end = std::to_chars(buf, buf + sizeof(buf), answer).ptr;
+            text.append(buf, end);
+            text += ' ';
+        }
+        std::cout.write(text.data(), text.size());
+        stat.items += batch.answers.size();
+    }
+    std::cout << std::endl;
+    stat.total_ms = (chrono_cur_time() - start_time) / 1.0ms;
+}
+
+}
+
+void run_tree_pipelined(std::istream & in_strm, latency_recorder_t* latency) {
+    auto commands = std::make_unique<command_ring_t>();
+    auto answers  = std::make_unique<answer_ring_t>();
+    stage_stat_t parse_stat   {"parse"};
+    stage_stat_t execute_stat {"execute"};
+    stage_stat_t format_stat  {"format"};
+
+    std::thread parser([&] {parse_stage(in_strm, *commands, parse_stat);});
+    std::thread executor([&] {execute_stage(*commands, *answers, execute_stat, latency);});
+    format_stage(*answers, format_stat);
+    parser.join();
+    executor.join();
+
+    std::clog << std::setw(10) << "stage" << std::setw(12) << "items" << std::setw(12)
+              << "busy_ms" << std::setw(12) << "wait_ms" << std::setw(14) << "items/s\n";
+    for (const auto* stat : {&parse_stat, &execute_stat, &format_stat}) {
+        double busy_ms = stat->total_ms - stat->wait_ms;
+        std::clog << std::setw(10) << stat->name << std::setw(12) << stat->items
+                  << std::setw(12) << busy_ms << std::setw(12) << stat->wait_ms
+                  << std::setw(13) << (busy_ms > 0 ? stat->items / busy_ms * 1e3 : 0) << '\n';
+    }
+}
+
+//-----------------------------------------------------------------------------------------
+
 void run_set_and_tree(std::istream & in_strm) {
     avl::tree_t<int> pine;
     std::set<int> enemy_set;
@@ -8,6 +8,7 @@
 #include "debug_utils.hpp"
 #include "time_control.hpp"
 #include "avl_tree.hpp"
+#include "btree.hpp"
 
 //-----------------------------------------------------------------------------------------
 
@@ -15,7 +16,21 @@ namespace avl_tree_ui {
 
 using namespace time_control;
 
-void run_tree(std::istream & in_strm = std::cin);
+// backend of run_tree, B+-tree is chosen with -DBTREE_BACKEND=ON
+#ifdef AVL_BTREE_BACKEND
+template<typename key_type> using default_tree_t = avl::btree_t<key_type>;
+#else
+template<typename key_type> using default_tree_t = avl::tree_t<key_type>;
+#endif
+
+// operations timed by run_tree if it gets a latency recorder
+enum tree_op_t : size_t {op_insert = 0, op_range_query = 1};
+inline std::vector<std::string> tree_op_names() {return {"insert", "range_query"};}
+
+void run_tree(std::istream & in_strm = std::cin, latency_recorder_t* latency = nullptr);
+// run_tree with parsing, tree work and printing on three threads, same output
+void run_tree_pipelined(std::istream & in_strm = std::cin,
+                        latency_recorder_t* latency = nullptr);
 void run_set_and_tree(std::istream & in_strm = std::cin);
 void run_set(std::istream & in_strm = std::cin);
 
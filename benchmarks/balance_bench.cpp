@@ -0,0 +1,69 @@
+#include "bench_utils.hpp"
+#include "avl_tree.hpp"
+#include <string>
+
+//-----------------------------------------------------------------------------------------
+
+// Balancing policies of tree_t on random and sorted inserts: rotations per insert, height
+// of the tree, insert time and find latency.
+
+namespace {
+
+template<typename key_type>
+size_t real_height(const avl::node_t<key_type>* node) {
+    if (node == nullptr)
+        return 0;
+    return 1 + std::max(real_height(node->get_left().get()), real_height(node->get_right().get()));
+}
+
+template<typename balance_type>
+void run(const std::string& name, const std::vector<int>& keys, const std::vector<int>& queries) {
+    avl::tree_t<int, false, balance_type> tree;
+
+    avl::balance::num_of_rotations = 0;
+    double insert_ms = bench::measure_ms([&] {
+        for (int key : keys)
+            tree.insert(key);
+    });
+    double rotations = double(avl::balance::num_of_rotations) / keys.size();
+
+    size_t found = 0;
+    double find_ms = bench::measure_ms([&] {
+        for (int key : queries)
+            found += tree.find(key).is_valid();
+    });
+    if (found == queries.size() + 1)
+        std::cerr << found << '\n';
+
+    std::cout << std::setw(14) << name;
+    bench::print_row(tree.size(), {rotations, double(real_height(tree.get_root())), insert_ms,
+                                   find_ms * 1e6 / queries.size()});
+}
+
+template<typename balance_type>
+void run_all(const std::string& name, size_t max_num) {
+    for (size_t num = 10'000; num <= max_num; num *= 10) {
+        std::vector<int> keys    = bench::random_keys(num);
+        std::vector<int> queries = bench::random_keys(1'000'000, 7);
+        for (size_t i = 0; i < queries.size(); i += 2)
+            queries[i] = keys[static_cast<unsigned>(queries[i]) % keys.size()];
+
+        run<balance_type>(name + "_rand", keys, queries);
+        std::sort(keys.begin(), keys.end());
+        run<balance_type>(name + "_sort", keys, queries);
+    }
+}
+
+}
+
+//-----------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    size_t max_num = (argc > 1) ? std::stoul(argv[1]) : 1'000'000;
+
+    bench::print_header({"policy", "n", "rot/insert", "height", "insert_ms", "find_ns"});
+    run_all<avl::balance::avl_t>   ("avl",    max_num);
+    run_all<avl::balance::wavl_t>  ("wavl",   max_num);
+    run_all<avl::balance::weight_t>("weight", max_num);
+    return 0;
+}
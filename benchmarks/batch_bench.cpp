@@ -0,0 +1,62 @@
+#include "bench_utils.hpp"
+#include "avl_tree.hpp"
+#include <string>
+
+//-----------------------------------------------------------------------------------------
+
+// Batched lookups with prefetch against one call per query, on random keys. Small trees
+// fit in cache and gain little, once the tree outgrows the last level cache the batch
+// overlaps the misses of independent descents.
+
+namespace {
+
+void run(size_t num) {
+    std::vector<int> keys    = bench::random_keys(num);
+    std::vector<int> queries = bench::random_keys(500'000, 7);
+    std::vector<std::pair<int, int>> bounds;
+    for (size_t i = 0; i + 1 < queries.size(); i += 2)
+        bounds.push_back({std::min(queries[i], queries[i + 1]),
+                          std::max(queries[i], queries[i + 1])});
+
+    avl::tree_t<int> tree;
+    for (int key : keys)
+        tree.insert(key);
+
+    size_t checksum = 0;
+    double lower_ms = bench::measure_ms([&] {
+        for (int key : queries)
+            checksum += tree.lower_bound(key).get_key();
+    });
+    double lower_batch_ms = bench::measure_ms([&] {
+        for (auto& node : tree.lower_bound_batch(queries))
+            checksum += node.get_key();
+    });
+    double range_ms = bench::measure_ms([&] {
+        for (auto [l_bound, u_bound] : bounds)
+            checksum += tree.range_query(l_bound, u_bound);
+    });
+    double range_batch_ms = bench::measure_ms([&] {
+        for (size_t count : tree.range_query_batch(bounds))
+            checksum += count;
+    });
+    if (checksum == 1)
+        std::cerr << checksum << '\n';
+
+    double lower_ns = 1e6 / queries.size();
+    double range_ns = 1e6 / bounds.size();
+    bench::print_row(tree.size(), {lower_ms * lower_ns, lower_batch_ms * lower_ns,
+                                   range_ms * range_ns, range_batch_ms * range_ns});
+}
+
+}
+
+//-----------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    size_t max_num = (argc > 1) ? std::stoul(argv[1]) : 4'000'000;
+
+    bench::print_header({"n", "lower_ns", "lower_batch", "range_ns", "range_batch"});
+    for (size_t num = 10'000; num <= max_num; num *= 4)
+        run(num);
+    return 0;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+//-----------------------------------------------------------------------------------------
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include "graphviz.h"
+#include "debug_utils.hpp"
+#include "time_control.hpp"
+
+//-----------------------------------------------------------------------------------------
+
+namespace bench {
+
+using namespace time_control;
+
+inline std::vector<int> random_keys(size_t num, unsigned seed = 42) {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> dist(-1'000'000'000, 1'000'000'000);
+
+    std::vector<int> keys(num);
+    for (auto& key : keys)
+        key = dist(gen);
+    return keys;
+}
+
+template<typename F>
+double measure_ms(F&& func) {
+    auto start_time = chrono_cur_time();
+    func();
+    auto end_time   = chrono_cur_time();
+    return (end_time - start_time) / 1.0ms;
+}
+
+inline void print_row(size_t num, std::initializer_list<double> cols) {
+    std::cout << std::setw(14) << num;
+    for (double col : cols)
+        std::cout << std::setw(14) << col;
+    std::cout << '\n';
+}
+
+inline void print_header(std::initializer_list<const char*> cols) {
+    for (const char* col : cols)
+        std::cout << std::setw(14) << col;
+    std::cout << '\n';
+}
+
+}
+
+//-----------------------------------------------------------------------------------------
@@ -0,0 +1,88 @@
+#include "bench_utils.hpp"
+#include "avl_tree.hpp"
+#include "btree.hpp"
+#include <set>
+#include <string>
+
+//-----------------------------------------------------------------------------------------
+
+// B+-tree backend against AVL tree and std::set on random keys: insert time, lower_bound
+// latency and range_query latency (std::set counts the range with std::distance).
+
+namespace {
+
+struct workload_t {
+    std::vector<int> keys;
+    std::vector<int> queries;
+    std::vector<std::pair<int, int>> ranges;
+};
+
+workload_t make_workload(size_t num) {
+    workload_t load;
+    load.keys    = bench::random_keys(num);
+    load.queries = bench::random_keys(1'000'000, 7);
+    std::vector<int> widths = bench::random_keys(100'000, 11);
+    for (size_t i = 0; i < widths.size(); ++i) {
+        int l_bound = load.queries[i];
+        load.ranges.push_back({l_bound, l_bound + (widths[i] & 0xfffff)});  // ~1/4000 of keys
+    }
+    return load;
+}
+
+template<typename tree_type>
+void run(const std::string& name, const workload_t& load, tree_type& tree) {
+    double insert_ms = bench::measure_ms([&] {
+        for (int key : load.keys)
+            tree.insert(key);
+    });
+
+    size_t checksum = 0;
+    double lower_ms = bench::measure_ms([&] {
+        for (int key : load.queries) {
+            auto found = tree.lower_bound(key);
+            if constexpr (std::is_same_v<tree_type, std::set<int>>)
+                checksum += (found != tree.end());
+            else if constexpr (std::is_pointer_v<decltype(found)>)
+                checksum += (found != nullptr);
+            else
+                checksum += found.is_valid();
+        }
+    });
+
+    double range_ms = bench::measure_ms([&] {
+        for (auto [l_bound, u_bound] : load.ranges) {
+            if constexpr (std::is_same_v<tree_type, std::set<int>>)
+                checksum += std::distance(tree.lower_bound(l_bound), tree.upper_bound(u_bound));
+            else
+                checksum += tree.range_query(l_bound, u_bound);
+        }
+    });
+    if (checksum == 1)
+        std::cerr << checksum << '\n';
+
+    std::cout << std::setw(14) << name;
+    bench::print_row(tree.size(), {insert_ms, lower_ms * 1e6 / load.queries.size(),
+                                   range_ms * 1e6 / load.ranges.size()});
+}
+
+}
+
+//-----------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    size_t max_num = (argc > 1) ? std::stoul(argv[1]) : 4'000'000;
+
+    bench::print_header({"backend", "n", "insert_ms", "lower_ns", "range_ns"});
+    for (size_t num = 100'000; num <= max_num; num *= 4) {
+        workload_t load = make_workload(num);
+        // every container lives to the end of the round, so none of them reuses
+        // memory freed by another one
+        avl::tree_t<int>  avl_tree;
+        avl::btree_t<int> btree;
+        std::set<int>     enemy_set;
+        run("avl",   load, avl_tree);
+        run("btree", load, btree);
+        run("std_set", load, enemy_set);
+    }
+    return 0;
+}
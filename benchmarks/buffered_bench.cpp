@@ -0,0 +1,59 @@
+#include "bench_utils.hpp"
+#include "buffered_tree.hpp"
+#include <string>
+
+//-----------------------------------------------------------------------------------------
+
+// Ingest bursts of random keys with a range query after every burst: eager tree_t
+// inserts against buffered_tree_t that merges its buffer at 2^20 keys and answers the
+// queries from the tree and the sorted buffer.
+
+namespace {
+
+constexpr size_t burst_size = 100'000;
+
+template<typename T>
+double ingest_ms(T& tree, const std::vector<int>& keys, size_t& checksum) {
+    return bench::measure_ms([&] {
+        for (size_t i = 0; i < keys.size(); ++i) {
+            tree.insert(keys[i]);
+            if (i % burst_size == burst_size - 1)
+                checksum += tree.range_query(-500'000'000, 500'000'000);
+        }
+    });
+}
+
+void run(size_t num) {
+    std::vector<int> keys = bench::random_keys(num);
+    size_t checksum = 0;
+
+    avl::tree_t<int> eager_tree;
+    double eager_ms = ingest_ms(eager_tree, keys, checksum);
+
+    avl::buffered_tree_t<int> buffered_tree;
+    double buffered_ms = ingest_ms(buffered_tree, keys, checksum);
+    double merge_ms = bench::measure_ms([&] {buffered_tree.merge();});
+
+    avl::buffer_config_t config;
+    config.merge_on_query = true;
+    avl::buffered_tree_t<int> lazy_tree {config};
+    double lazy_ms = ingest_ms(lazy_tree, keys, checksum);
+
+    if (checksum == 1)
+        std::cerr << checksum << '\n';
+    double ns = 1e6 / num;
+    bench::print_row(num, {eager_ms * ns, (buffered_ms + merge_ms) * ns, lazy_ms * ns,
+                           double(buffered_tree.num_of_merges())});
+}
+
+}
+
+//-----------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    size_t max_num = (argc > 1) ? std::stoul(argv[1]) : 4'000'000;
+
+    bench::print_header({"n", "eager_ns", "buffered_ns", "lazy_merge", "merges"});
+    for (size_t num = 250'000; num <= max_num; num *= 2)
+        run(num);
+}
@@ -0,0 +1,48 @@
+#include "bench_utils.hpp"
+#include "avl_tree.hpp"
+#include <set>
+#include <thread>
+
+//-----------------------------------------------------------------------------------------
+
+// Copy of a whole tree: block clone (one and all threads) vs node by node safe_copy
+// vs std::set copy.
+
+int main(int argc, char* argv[]) {
+    size_t max_num = (argc > 1) ? std::stoul(argv[1]) : 4'000'000;
+    size_t n_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << "threads: " << n_threads << '\n';
+    bench::print_header({"n", "safe_copy_ms", "clone_1_ms", "clone_all_ms", "set_copy_ms"});
+    for (size_t num = 1'000'000; num <= max_num; num *= 2) {
+        std::vector<int> keys = bench::random_keys(num);
+        avl::tree_t<int> tree;
+        std::set<int> enemy_set;
+        for (int key : keys) {
+            tree.insert(key);
+            enemy_set.insert(key);
+        }
+        const avl::node_t<int>* root = tree.get_root();
+
+        avl::node_t<int>::unique_ptr_node_t node_copy = nullptr;
+        double safe_copy_ms = bench::measure_ms([&] {
+            node_copy = avl::node_t<int>::safe_copy(*root);
+        });
+        node_copy.reset();
+        double clone_1_ms = bench::measure_ms([&] {
+            node_copy = avl::node_t<int>::clone(root, 1);
+        });
+        node_copy.reset();
+
+        avl::tree_t<int> tree_copy;
+        double clone_all_ms = bench::measure_ms([&] {
+            tree_copy = tree;
+        });
+        std::set<int> set_copy;
+        double set_copy_ms = bench::measure_ms([&] {
+            set_copy = enemy_set;
+        });
+        bench::print_row(num, {safe_copy_ms, clone_1_ms, clone_all_ms, set_copy_ms});
+    }
+    return 0;
+}
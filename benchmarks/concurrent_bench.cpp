@@ -0,0 +1,97 @@
+#include "bench_utils.hpp"
+#include "concurrent_tree.hpp"
+#include <string>
+#include <thread>
+
+//-----------------------------------------------------------------------------------------
+
+// Throughput of a shared tree against the number of threads: concurrent_tree_t (combined
+// writers, shared readers) and tree_t under one std::mutex. Every thread does the same
+// number of operations, write_percent of them inserts or erases, the rest range queries.
+
+namespace {
+
+constexpr size_t num_of_ops = 400'000;
+
+template<typename F>
+double run_threads(size_t num_of_threads, F thread_func) {
+    return bench::measure_ms([&] {
+        std::vector<std::thread> threads;
+        for (size_t thread = 0; thread < num_of_threads; ++thread)
+            threads.emplace_back(thread_func, thread);
+        for (auto& thread : threads)
+            thread.join();
+    });
+}
+
+template<typename F>
+void thread_ops(size_t thread, unsigned write_percent, F&& apply) {
+    std::vector<int> keys = bench::random_keys(num_of_ops, thread + 1);
+    for (size_t i = 0; i < keys.size(); ++i) {
+        unsigned kind = unsigned(keys[i]) % 100;
+        int key = keys[i] / 100;
+        if (kind < write_percent)
+            apply(kind % 2 == 0 ? 'k' : 'e', key, key);
+        else
+            apply('q', key, key + 1'000'000);
+    }
+}
+
+void run(size_t num_of_threads, unsigned write_percent) {
+    std::vector<int> init_keys = bench::random_keys(200'000);
+    std::atomic<size_t> checksum = 0;
+
+    avl::concurrent_tree_t<int> shared_tree;
+    for (int key : init_keys)
+        shared_tree.insert(key / 100);
+    double combined_ms = run_threads(num_of_threads, [&](size_t thread) {
+        size_t sum = 0;
+        thread_ops(thread, write_percent, [&](char op, int l_bound, int u_bound) {
+            if (op == 'k')
+                sum += shared_tree.insert(l_bound);
+            else if (op == 'e')
+                sum += shared_tree.erase(l_bound);
+            else
+                sum += shared_tree.range_query(l_bound, u_bound);
+        });
+        checksum += sum == 1;
+    });
+
+    avl::tree_t<int> locked_tree;
+    std::mutex tree_lock;
+    for (int key : init_keys)
+        locked_tree.insert(key / 100);
+    double locked_ms = run_threads(num_of_threads, [&](size_t thread) {
+        size_t sum = 0;
+        thread_ops(thread, write_percent, [&](char op, int l_bound, int u_bound) {
+            std::lock_guard<std::mutex> lock(tree_lock);
+            if (op == 'k')
+                locked_tree.insert(l_bound);
+            else if (op == 'e')
+                sum += locked_tree.erase(l_bound);
+            else
+                sum += locked_tree.range_query(l_bound, u_bound);
+        });
+        checksum += sum == 1;
+    });
+    if (checksum == 1'000'000)
+        std::cerr << checksum << '\n';
+
+    double all_ops = double(num_of_ops) * num_of_threads;
+    bench::print_row(num_of_threads, {write_percent * 1.0, all_ops / combined_ms / 1e3,
+                                      all_ops / locked_ms / 1e3});
+}
+
+}
+
+//-----------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    size_t max_threads = (argc > 1) ? std::stoul(argv[1]) : 8;
+
+    std::cout << "Mops/s, hardware threads: " << std::thread::hardware_concurrency() << '\n';
+    bench::print_header({"threads", "write_%", "combined", "mutex"});
+    for (unsigned write_percent : {10u, 50u, 100u})
+        for (size_t num_of_threads = 1; num_of_threads <= max_threads; num_of_threads *= 2)
+            run(num_of_threads, write_percent);
+}
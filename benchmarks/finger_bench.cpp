@@ -0,0 +1,98 @@
+#include "bench_utils.hpp"
+#include "avl_tree.hpp"
+#include <fstream>
+#include <set>
+#include <string>
+
+//-----------------------------------------------------------------------------------------
+
+// Insertion with the finger (tree_t::insert) vs insertion from the root (the root as
+// hint of insert(hint, key)) vs std::set on sorted, reverse and k-sorted key streams.
+// Streams are read from files made by tests/end_to_end_tests/test_generator.py
+// --order ..., or are generated here if no files are given.
+
+namespace {
+
+// keys of "k <key>" records of a test_generator file
+std::vector<int> read_keys(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open())
+        throw("Can not open file with keys");
+
+    std::vector<int> keys;
+    std::string token;
+    while (file >> token) {
+        if (token != "k")
+            continue;
+        int key = 0;
+        file >> key;
+        keys.push_back(key);
+    }
+    return keys;
+}
+
+std::vector<int> k_sorted(size_t num, size_t k) {
+    std::vector<int> keys = bench::random_keys(num);
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    std::mt19937 gen(11);
+    for (size_t i = 0; i < keys.size(); i += k)
+        std::shuffle(keys.begin() + i, keys.begin() + std::min(keys.size(), i + k), gen);
+    return keys;
+}
+
+// measures only insertions, every container takes fresh memory and lives to the end of
+// run(), so the one measured first does not get nodes freed by the others
+template<typename container_type, typename F>
+double measure_inserts(const std::vector<int>& keys, container_type& container, F insert) {
+    return bench::measure_ms([&] {
+        for (int key : keys)
+            insert(container, key);
+    });
+}
+
+void run(const std::string& name, const std::vector<int>& keys) {
+    avl::tree_t<int> finger_tree;
+    avl::tree_t<int> root_tree;
+    std::set<int> set;
+
+    double finger_ms = measure_inserts(keys, finger_tree, [](avl::tree_t<int>& tree, int key) {
+        tree.insert(key);
+    });
+    double root_ms   = measure_inserts(keys, root_tree, [](avl::tree_t<int>& tree, int key) {
+        // the root as the hint: an empty hint would use the finger as well
+        tree.insert(avl::wrap_node_t<int>(const_cast<avl::node_t<int>*>(tree.get_root())), key);
+    });
+    double set_ms    = measure_inserts(keys, set, [](std::set<int>& set, int key) {
+        set.insert(key);
+    });
+    if (finger_tree.size() != set.size() || root_tree.size() != set.size())
+        std::cerr << "sizes differ\n";
+
+    std::cout << std::setw(14) << name;
+    bench::print_row(keys.size(), {finger_ms, root_ms, set_ms});
+}
+
+}
+
+//-----------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    bench::print_header({"input", "n", "finger_ms", "root_ms", "set_ms"});
+    if (argc > 1) {
+        for (int i = 1; i < argc; ++i)
+            run(std::string(argv[i]).substr(std::string(argv[i]).find_last_of('/') + 1),
+                read_keys(argv[i]));
+        return 0;
+    }
+
+    const size_t num = 1'000'000;
+    std::vector<int> sorted = k_sorted(num, 1);
+    run("random",   bench::random_keys(num));
+    run("sorted",   sorted);
+    run("reverse",  std::vector<int>(sorted.rbegin(), sorted.rend()));
+    run("k_sorted8",   k_sorted(num, 8));
+    run("k_sorted256", k_sorted(num, 256));
+    return 0;
+}
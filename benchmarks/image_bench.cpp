@@ -0,0 +1,50 @@
+#include "bench_utils.hpp"
+#include "tree_image.hpp"
+
+//-----------------------------------------------------------------------------------------
+
+// Startup cost of a tree rebuilt by re-insertion vs a mapped image of the same keys.
+
+int main(int argc, char* argv[]) {
+    size_t max_num = (argc > 1) ? std::stoul(argv[1]) : 1'000'000;
+    const char* image_path = "./image_bench.avlimg";
+    const size_t num_of_queries = 100'000;
+
+    bench::print_header({"n", "rebuild_ms", "write_ms", "map_ms",
+                         "tree_q_ms", "image_q_ms"});
+    for (size_t num = 10'000; num <= max_num; num *= 10) {
+        std::vector<int> keys    = bench::random_keys(num);
+        std::vector<int> queries = bench::random_keys(2 * num_of_queries, 7);
+
+        avl::tree_t<int> tree;
+        double rebuild_ms = bench::measure_ms([&] {
+            for (int key : keys)
+                tree.insert(key);
+        });
+        double write_ms = bench::measure_ms([&] {
+            avl::image::write(tree, image_path);
+        });
+
+        size_t tree_res  = 0;
+        size_t image_res = 0;
+        double tree_q_ms = bench::measure_ms([&] {
+            for (size_t i = 0; i < queries.size(); i += 2)
+                tree_res += tree.range_query(queries[i], queries[i + 1]);
+        });
+
+        std::unique_ptr<avl::mapped_tree_t<int>> mapped = nullptr;
+        double map_ms = bench::measure_ms([&] {
+            mapped = std::make_unique<avl::mapped_tree_t<int>>(image_path);
+        });
+        double image_q_ms = bench::measure_ms([&] {
+            for (size_t i = 0; i < queries.size(); i += 2)
+                image_res += mapped->range_query(queries[i], queries[i + 1]);
+        });
+        if (tree_res != image_res)
+            std::cerr << "Mismatch of results\n";
+
+        bench::print_row(num, {rebuild_ms, write_ms, map_ms, tree_q_ms, image_q_ms});
+    }
+    std::remove(image_path);
+    return 0;
+}
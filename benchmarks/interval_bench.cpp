@@ -0,0 +1,66 @@
+#include "bench_utils.hpp"
+#include "interval_tree.hpp"
+#include <string>
+
+//-----------------------------------------------------------------------------------------
+
+// Stabbing counts and overlap reports on random intervals against a scan of all of them.
+// Intervals are short (up to 1000 on a range of 10^9), so an answer has few intervals and
+// the cost of the tree is the descent while the scan is linear in n.
+
+namespace {
+
+void run(size_t num) {
+    std::mt19937 gen(5);
+    std::uniform_int_distribution<int> low_dist(0, 1'000'000'000);
+    std::uniform_int_distribution<int> len_dist(0, 1000);
+
+    avl::interval_tree_t<int> tree;
+    std::vector<avl::interval_t<int>> intervals(num);
+    for (auto& interval : intervals) {
+        interval.low  = low_dist(gen);
+        interval.high = interval.low + len_dist(gen);
+    }
+    double insert_ms = bench::measure_ms([&] {
+        for (auto& interval : intervals)
+            tree.insert(interval.low, interval.high);
+    });
+
+    std::vector<int> points(std::max<size_t>(1000, 20'000'000 / num));
+    for (auto& point : points)
+        point = low_dist(gen);
+
+    size_t checksum = 0;
+    double count_ms = bench::measure_ms([&] {
+        for (int point : points)
+            checksum += tree.count_stabbing(point);
+    });
+    double report_ms = bench::measure_ms([&] {
+        for (int point : points)
+            tree.overlaps(point, point + 10'000, [&](auto& interval) {checksum += interval.low;});
+    });
+    double scan_ms = bench::measure_ms([&] {
+        for (int point : points)
+            for (auto& interval : intervals)
+                if (interval.overlaps(point, point + 10'000))
+                    checksum += interval.low;
+    });
+    if (checksum == 1)
+        std::cerr << checksum << '\n';
+
+    double query_ns = 1e6 / points.size();
+    bench::print_row(num, {insert_ms * 1e6 / num, count_ms * query_ns, report_ms * query_ns,
+                           scan_ms * query_ns});
+}
+
+}
+
+//-----------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    size_t max_num = (argc > 1) ? std::stoul(argv[1]) : 1'000'000;
+
+    bench::print_header({"n", "insert_ns", "stab_count", "overlap_rep", "scan_ns"});
+    for (size_t num = 1'000; num <= max_num; num *= 10)
+        run(num);
+}
@@ -0,0 +1,74 @@
+#include "bench_utils.hpp"
+#include "durable_tree.hpp"
+
+//-----------------------------------------------------------------------------------------
+
+// Ingest throughput of tree_t with and without the journal.
+
+namespace {
+
+void remove_journal(const std::string& dir) {
+    std::remove((dir + "/journal.log").c_str());
+    std::remove((dir + "/checkpoint.dat").c_str());
+    std::remove(dir.c_str());
+}
+
+double durable_ingest(const std::vector<int>& keys, size_t group_size, bool sync) {
+    const std::string dir = "./journal_bench_dir";
+    remove_journal(dir);
+
+    avl::journal_config_t config;
+    config.group_size = group_size;
+    config.sync       = sync;
+    double ingest_ms = bench::measure_ms([&] {
+        avl::durable_tree_t<int> tree {dir, config};
+        for (int key : keys)
+            tree.insert(key);
+    });
+    remove_journal(dir);
+    return ingest_ms;
+}
+
+double recovery(const std::vector<int>& keys) {
+    const std::string dir = "./journal_bench_dir";
+    remove_journal(dir);
+
+    avl::journal_config_t config;
+    config.checkpoint_every = keys.size() / 2 + 1;
+    {
+        avl::durable_tree_t<int> tree {dir, config};
+        for (int key : keys)
+            tree.insert(key);
+    }
+    double recovery_ms = bench::measure_ms([&] {
+        avl::durable_tree_t<int> tree {dir, config};
+    });
+    remove_journal(dir);
+    return recovery_ms;
+}
+
+}
+
+//-----------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    size_t num = (argc > 1) ? std::stoul(argv[1]) : 1'000'000;
+    std::vector<int> keys = bench::random_keys(num);
+
+    double plain_ms = bench::measure_ms([&] {
+        avl::tree_t<int> tree;
+        for (int key : keys)
+            tree.insert(key);
+    });
+
+    std::cout << "keys: " << num << ", ops/sec\n";
+    bench::print_header({"group", "no_journal", "no_sync", "fdatasync"});
+    for (size_t group_size : {16, 256, 4096}) {
+        double no_sync_ms = durable_ingest(keys, group_size, false);
+        double sync_ms    = durable_ingest(keys, group_size, true);
+        bench::print_row(group_size, {num / plain_ms * 1000, num / no_sync_ms * 1000,
+                                      num / sync_ms * 1000});
+    }
+    std::cout << "recovery from checkpoint + half journal: " << recovery(keys) << " ms\n";
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include "bench_utils.hpp"
+#include "avl_map.hpp"
+#include <array>
+
+//-----------------------------------------------------------------------------------------
+
+// find() with values kept apart from the nodes (map_t) vs key-only tree_t vs values
+// stored inline in the node.
+
+namespace {
+
+using value_type = std::array<char, 128>;
+
+struct inline_entry_t {
+    int key;
+    value_type value;
+
+    bool operator< (const inline_entry_t& rhs) const {return key < rhs.key;};
+    bool operator> (const inline_entry_t& rhs) const {return rhs.key < key;};
+    bool operator==(const inline_entry_t& rhs) const {return key == rhs.key;};
+};
+
+}
+
+//-----------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    size_t max_num = (argc > 1) ? std::stoul(argv[1]) : 1'000'000;
+    const size_t num_of_queries = 1'000'000;
+
+    bench::print_header({"n", "tree_ms", "map_ms", "inline_ms"});
+    for (size_t num = 10'000; num <= max_num; num *= 10) {
+        std::vector<int> keys    = bench::random_keys(num);
+        std::vector<int> queries = bench::random_keys(num_of_queries, 7);
+        for (size_t i = 0; i < queries.size(); i += 2)
+            queries[i] = keys[static_cast<unsigned>(queries[i]) % keys.size()]; // half hits
+
+        avl::tree_t<int> tree;
+        avl::map_t<int, value_type> map;
+        avl::tree_t<inline_entry_t> inline_tree;
+        for (int key : keys) {
+            tree.insert(key);
+            map.try_emplace(key);
+            inline_tree.insert({key, {}});
+        }
+
+        size_t found = 0;
+        double tree_ms = bench::measure_ms([&] {
+            for (int key : queries)
+                found += tree.find(key).is_valid();
+        });
+        double map_ms = bench::measure_ms([&] {
+            for (int key : queries) {
+                const value_type* value = map.find(key);
+                found += (value != nullptr) ? (*value)[0] + 1 : 0;
+            }
+        });
+        double inline_ms = bench::measure_ms([&] {
+            for (int key : queries) {
+                auto node = inline_tree.find({key, {}});
+                found += node.is_valid() ? node.get_key().value[0] + 1 : 0;
+            }
+        });
+        if (found % (3 * num_of_queries) == 1)
+            std::cerr << found << '\n';
+
+        bench::print_row(num, {tree_ms, map_ms, inline_ms});
+    }
+    return 0;
+}
@@ -0,0 +1,67 @@
+#include "bench_utils.hpp"
+#include "range_tree_2d.hpp"
+#include <string>
+
+//-----------------------------------------------------------------------------------------
+
+// Counting points in random rectangles: range_tree_2d_t against a scan of all points and
+// against a 1-D filter (binary search of the x range in points sorted by x, then a scan
+// of it checking y). Rectangles cover about 1/100 of every axis.
+
+namespace {
+
+void run(size_t num) {
+    std::vector<int> coords = bench::random_keys(2 * num);
+    std::vector<std::pair<int, int>> points(num);
+    for (size_t i = 0; i < num; ++i)
+        points[i] = {coords[2 * i], coords[2 * i + 1]};
+
+    avl::range_tree_2d_t<int, int> tree;
+    double build_ms = bench::measure_ms([&] {tree = avl::range_tree_2d_t<int, int>{points};});
+    std::vector<std::pair<int, int>> sorted_points = points;
+    std::sort(sorted_points.begin(), sorted_points.end());
+
+    std::vector<int> corners = bench::random_keys(2'000, 3);
+    constexpr int side = 20'000'000;
+    size_t num_of_queries = corners.size() / 2;
+    size_t tree_count = 0, scan_count = 0, filter_count = 0;
+
+    double tree_ms = bench::measure_ms([&] {
+        for (size_t i = 0; i < corners.size(); i += 2)
+            tree_count += tree.count(corners[i], corners[i] + side,
+                                     corners[i + 1], corners[i + 1] + side);
+    });
+    double scan_ms = bench::measure_ms([&] {
+        for (size_t i = 0; i < corners.size(); i += 2)
+            for (auto [x, y] : points)
+                scan_count += corners[i] <= x && x <= corners[i] + side &&
+                              corners[i + 1] <= y && y <= corners[i + 1] + side;
+    });
+    double filter_ms = bench::measure_ms([&] {
+        for (size_t i = 0; i < corners.size(); i += 2) {
+            auto first = std::lower_bound(sorted_points.begin(), sorted_points.end(),
+                                          std::make_pair(corners[i], INT32_MIN));
+            for (; first != sorted_points.end() && first->first <= corners[i] + side; ++first)
+                filter_count += corners[i + 1] <= first->second &&
+                                first->second <= corners[i + 1] + side;
+        }
+    });
+    if (tree_count != scan_count || tree_count != filter_count)
+        std::cerr << "different counts: " << tree_count << ' ' << scan_count << ' '
+                  << filter_count << '\n';
+
+    double ns = 1e6 / num_of_queries;
+    bench::print_row(num, {build_ms, tree_ms * ns, filter_ms * ns, scan_ms * ns});
+}
+
+}
+
+//-----------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    size_t max_num = (argc > 1) ? std::stoul(argv[1]) : 4'000'000;
+
+    bench::print_header({"n", "build_ms", "tree_ns", "filter_1d_ns", "scan_ns"});
+    for (size_t num = 10'000; num <= max_num; num *= 4)
+        run(num);
+}
@@ -0,0 +1,80 @@
+#include "bench_utils.hpp"
+#include "compressed_snapshot.hpp"
+#include <string>
+
+//-----------------------------------------------------------------------------------------
+
+// Size and range query speed of compressed_snapshot_t against the sorted array of
+// store_inorder_walk() and the live tree, for sparse keys (random int) and dense keys
+// (random in [0, 4n)).
+
+namespace {
+
+void run(size_t num, bool is_dense) {
+    std::vector<int> keys = bench::random_keys(num);
+    if (is_dense)
+        for (auto& key : keys)
+            key = static_cast<int>(static_cast<unsigned>(key) % (4 * num));
+
+    avl::multiset_t<int> tree;
+    for (int key : keys)
+        tree.insert(key);
+    std::vector<int> sorted = tree.store_inorder_walk();
+    avl::compressed_snapshot_t<int> snapshot {sorted};
+
+    std::vector<int> queries = bench::random_keys(400'000, 9);
+    if (is_dense)
+        for (auto& key : queries)
+            key = static_cast<int>(static_cast<unsigned>(key) % (4 * num));
+    size_t snapshot_count = 0, array_count = 0, tree_count = 0;
+
+    auto bounds = [&](size_t i) {
+        return std::make_pair(std::min(queries[i], queries[i + 1]),
+                              std::max(queries[i], queries[i + 1]));
+    };
+    double snapshot_ms = bench::measure_ms([&] {
+        for (size_t i = 0; i + 1 < queries.size(); i += 2) {
+            auto [l_bound, u_bound] = bounds(i);
+            snapshot_count += snapshot.range_query(l_bound, u_bound);
+        }
+    });
+    double array_ms = bench::measure_ms([&] {
+        for (size_t i = 0; i + 1 < queries.size(); i += 2) {
+            auto [l_bound, u_bound] = bounds(i);
+            if (l_bound < u_bound)
+                array_count += std::upper_bound(sorted.begin(), sorted.end(), u_bound) -
+                               std::lower_bound(sorted.begin(), sorted.end(), l_bound);
+        }
+    });
+    double tree_ms = bench::measure_ms([&] {
+        for (size_t i = 0; i + 1 < queries.size(); i += 2) {
+            auto [l_bound, u_bound] = bounds(i);
+            tree_count += tree.range_query(l_bound, u_bound);
+        }
+    });
+    if (snapshot_count != array_count || snapshot_count != tree_count)
+        std::cerr << "different counts\n";
+
+    double num_of_queries = queries.size() / 2;
+    double tree_bytes = double(avl::node_pool_t<avl::node_t<int>>::slot_size) *
+                        std::distance(sorted.begin(), std::unique(sorted.begin(), sorted.end()));
+    bench::print_row(num, {double(snapshot.bytes()) / num, sizeof(int) * 1.0, tree_bytes / num,
+                           num_of_queries / snapshot_ms / 1e3, num_of_queries / array_ms / 1e3,
+                           num_of_queries / tree_ms / 1e3});
+}
+
+}
+
+//-----------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    size_t max_num = (argc > 1) ? std::stoul(argv[1]) : 4'000'000;
+
+    for (bool is_dense : {false, true}) {
+        std::cout << (is_dense ? "dense keys\n" : "sparse keys\n");
+        bench::print_header({"n", "snap_B/key", "array_B/key", "tree_B/key",
+                             "snap_Mq/s", "array_Mq/s", "tree_Mq/s"});
+        for (size_t num = 16'000; num <= max_num; num *= 4)
+            run(num, is_dense);
+    }
+}
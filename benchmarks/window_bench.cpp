@@ -0,0 +1,55 @@
+#include "bench_utils.hpp"
+#include "window_tree.hpp"
+#include <string>
+
+//-----------------------------------------------------------------------------------------
+
+// Stream of random keys through windows of different size, a range query after every
+// 100 events. Every event past the first window costs one insert and one eviction, so
+// the rate depends on the window size only through the height of the tree.
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+void run(size_t window_size, size_t num_of_events, bool by_age) {
+    std::vector<int> keys = bench::random_keys(num_of_events);
+
+    // with by_age the window holds the last window_size microseconds of a stream of one
+    // event per microsecond, the count limit is only a bound of memory
+    auto max_age = by_age ? std::chrono::microseconds(window_size) : clock_type::duration::max();
+    avl::window_tree_t<int> window {window_size + 1, max_age, 64};
+    clock_type::time_point now {};
+
+    size_t checksum = 0;
+    double ms = bench::measure_ms([&] {
+        for (size_t i = 0; i < keys.size(); ++i) {
+            now += std::chrono::microseconds(1);
+            window.insert(keys[i], now);
+            if (i % 100 == 99)
+                checksum += window.range_query(std::min(keys[i - 1], keys[i]),
+                                               std::max(keys[i - 1], keys[i]), now);
+        }
+    });
+    if (checksum == 1)
+        std::cerr << checksum << '\n';
+
+    double events_per_sec = num_of_events / ms * 1e3;
+    bench::print_row(window_size, {events_per_sec / 1e6, 1e6 * ms / num_of_events,
+                                   double(window.size())});
+}
+
+}
+
+//-----------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    size_t num_of_events = (argc > 1) ? std::stoul(argv[1]) : 4'000'000;
+
+    for (bool by_age : {false, true}) {
+        std::cout << (by_age ? "window by age (us)\n" : "window by count\n");
+        bench::print_header({"window", "Mevents/s", "ns/event", "size"});
+        for (size_t window_size = 1'000; window_size <= 1'000'000; window_size *= 10)
+            run(window_size, num_of_events, by_age);
+    }
+}
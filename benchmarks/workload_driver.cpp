@@ -0,0 +1,407 @@
+#include "bench_utils.hpp"
+#include "avl_tree.hpp"
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <set>
+#include <string>
+#include <sys/resource.h>
+
+//-----------------------------------------------------------------------------------------
+
+// Native workload driver for performance runs of tree_t. Operations are generated in
+// chunks by a seeded generator, so traces of 10^8 operations need no file and no memory
+// for the whole trace:
+//
+//  uniform     - keys and query bounds uniform in [0, keys)
+//  zipf        - key ranks drawn from a zipfian distribution (s = 0.99), ranks are
+//                scattered over the key space
+//  sorted      - inserts of increasing keys, queries over the inserted part
+//  hot         - 90% of operations hit 1% of the key space
+//  adversarial - inserts converge from both ends of the key space to the middle, every
+//                insertion goes down a zig-zag path and costs double rotations
+//
+// A run is replayed on tree_t with timing, then regenerated and replayed on std::set:
+// every check_every-th answer of the tree must be equal to the one of std::set.
+//
+//  workload_driver [--workload name|all] [--ops N] [--keys N] [--ratio inserts:queries]
+//                  [--width N] [--seed N] [--check-every N] [--sample-every N]
+//                  [--baseline file] [--save-baseline file] [--tolerance share]
+//                  [--write-trace file]
+//
+// --baseline fails the run (exit code 1) if ops/sec of a workload drops or its p99
+// latency grows by more than tolerance against the file written by --save-baseline.
+// --write-trace stores the operations in the input format of avl_tree.
+// peak_rss_mb is VmHWM of the process, it is reset before every workload where the
+// kernel allows it; the node pool keeps its memory from one workload to the next.
+
+namespace {
+
+using namespace time_control;
+
+struct config_t {
+    std::string workload = "all";
+    size_t ops          = 2'000'000;
+    size_t keys         = 1'000'000;
+    size_t inserts      = 1;
+    size_t queries      = 1;
+    size_t width        = 1'000;
+    unsigned seed       = 42;
+    size_t check_every  = 16;
+    size_t sample_every = 16;
+    double tolerance    = 0.25;
+    std::string baseline;
+    std::string save_baseline;
+    std::string write_trace;
+};
+
+struct op_t {
+    bool is_insert;
+    int  l_bound;   // key of insert
+    int  u_bound;
+};
+
+struct result_t {
+    double ops_per_sec = 0;
+    double p50_ns  = 0;
+    double p99_ns  = 0;
+    double p999_ns = 0;
+    double max_ns  = 0;
+    double rss_mb  = 0;
+    double rotations_per_insert = 0;
+    size_t checked = 0;
+    size_t wrong   = 0;
+};
+
+//-----------------------------------------------------------------------------------------
+
+// zipfian ranks in [0, num) by the method of Gray et al. (as in YCSB), O(num) to set up
+class zipf_t final {
+    double theta_;
+    size_t num_;
+    double alpha_;
+    double zeta_n_;
+    double eta_;
+
+    static double zeta(size_t num, double theta) {
+        double sum = 0;
+        for (size_t idx = 1; idx <= num; ++idx)
+            sum += 1.0 / std::pow(double(idx), theta);
+        return sum;
+    }
+    public:
+        zipf_t(size_t num, double theta) :
+            theta_(theta), num_(num), alpha_(1.0 / (1.0 - theta)), zeta_n_(zeta(num, theta)) {
+            double zeta_2 = zeta(2, theta);
+            eta_ = (1.0 - std::pow(2.0 / num, 1.0 - theta)) / (1.0 - zeta_2 / zeta_n_);
+        }
+
+        template<typename gen_type>
+        size_t operator()(gen_type& gen) {
+            double u  = std::uniform_real_distribution<double>(0.0, 1.0)(gen);
+            double uz = u * zeta_n_;
+            if (uz < 1.0)
+                return 0;
+            if (uz < 1.0 + std::pow(0.5, theta_))
+                return 1;
+            size_t rank = size_t(num_ * std::pow(eta_ * u - eta_ + 1.0, alpha_));
+            return std::min(rank, num_ - 1);
+        }
+};
+
+class generator_t final {
+    config_t    config_;
+    std::string workload_;
+    std::mt19937_64 gen_;
+    std::uniform_int_distribution<size_t> op_dist_;
+    std::unique_ptr<zipf_t> zipf_;
+    size_t done_ = 0;
+
+    int uniform_key(size_t from, size_t num) {
+        return int(from + std::uniform_int_distribution<size_t>(0, num - 1)(gen_));
+    }
+    int scatter(size_t rank) const {  // a permutation of the key space
+        return int((rank * 2654435761ull) % config_.keys);
+    }
+
+    op_t next() {
+        bool is_insert = op_dist_(gen_) < config_.inserts;
+        size_t width = std::uniform_int_distribution<size_t>(0, config_.width)(gen_);
+        int key = 0;
+
+        if (workload_ == "uniform") {
+            key = uniform_key(0, config_.keys);
+        }
+        else if (workload_ == "zipf") {
+            key = scatter((*zipf_)(gen_));
+        }
+        else if (workload_ == "hot") {
+            size_t hot_size = std::max<size_t>(1, config_.keys / 100);
+            bool is_hot = std::uniform_int_distribution<int>(0, 9)(gen_) != 0;
+            key = is_hot ? uniform_key(config_.keys / 2, hot_size) :
+                           uniform_key(0, config_.keys);
+        }
+        else if (workload_ == "sorted") {
+            size_t step = std::max<size_t>(1, config_.keys / std::max<size_t>(1, config_.ops));
+            key = is_insert ? int(done_ * step) : uniform_key(0, done_ * step + 1);
+        }
+        else { // adversarial
+            size_t half = done_ / 2;
+            key = (done_ % 2) ? int(config_.keys - 1 - half % config_.keys) :
+                                int(half % config_.keys);
+            if (!is_insert)
+                key = uniform_key(0, config_.keys);
+        }
+        ++done_;
+        return {is_insert, key, is_insert ? 0 : int(key + width)};
+    }
+
+    public:
+        generator_t(const config_t& config, const std::string& workload) :
+            config_(config),
+            workload_(workload),
+            gen_(config.seed),
+            op_dist_(0, config.inserts + config.queries - 1) {
+            if (workload_ == "zipf")
+                zipf_ = std::make_unique<zipf_t>(config_.keys, 0.99);
+        }
+
+        void fill(std::vector<op_t>& chunk, size_t num) {
+            chunk.resize(num);
+            for (auto& op : chunk)
+                op = next();
+        }
+};
+
+//-----------------------------------------------------------------------------------------
+
+// peak RSS since the last reset in megabytes, /proc/self/clear_refs resets it on Linux
+void reset_peak_rss() {
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5";
+}
+
+double peak_rss_mb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+        if (line.rfind("VmHWM:", 0) == 0)
+            return std::stod(line.substr(6)) / 1024;
+    rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0;
+}
+
+double percentile(const std::vector<uint32_t>& sorted, double share) {
+    if (sorted.empty())
+        return 0;
+    return sorted[std::min(sorted.size() - 1, size_t(share * sorted.size()))];
+}
+
+constexpr size_t chunk_size = 1 << 20;
+
+result_t run(const config_t& config, const std::string& workload) {
+    result_t result;
+    std::vector<op_t> chunk;
+    std::vector<size_t> answers;      // every check_every-th answer of the tree
+    std::vector<uint32_t> latencies;  // every sample_every-th operation, ns
+
+    reset_peak_rss();
+    double total_ns = 0;
+    size_t num_of_inserts = 0;
+    avl::balance::num_of_rotations = 0;
+    {
+        avl::tree_t<int> tree;
+        generator_t generator(config, workload);
+        size_t query_idx = 0;
+        for (size_t done = 0; done < config.ops; done += chunk.size()) {
+            generator.fill(chunk, std::min(chunk_size, config.ops - done));
+
+            auto start_time = chrono_cur_time();
+            for (size_t idx = 0; idx < chunk.size(); ++idx) {
+                const op_t& op = chunk[idx];
+                bool is_sampled = (idx % config.sample_every == 0);
+                auto op_start = is_sampled ? chrono_cur_time() : start_time;
+                if (op.is_insert) {
+                    tree.insert(op.l_bound);
+                }
+                else {
+                    size_t answer = tree.range_query(op.l_bound, op.u_bound);
+                    if (query_idx++ % config.check_every == 0)
+                        answers.push_back(answer);
+                }
+                if (is_sampled)
+                    latencies.push_back(uint32_t((chrono_cur_time() - op_start) / 1ns));
+            }
+            total_ns += (chrono_cur_time() - start_time) / 1ns;
+            for (const auto& op : chunk)
+                num_of_inserts += op.is_insert;
+        }
+        result.rss_mb = peak_rss_mb();
+    }
+    result.rotations_per_insert = double(avl::balance::num_of_rotations) /
+                                  std::max<size_t>(1, num_of_inserts);
+    result.ops_per_sec = config.ops / (total_ns * 1e-9);
+
+    std::sort(latencies.begin(), latencies.end());
+    result.p50_ns  = percentile(latencies, 0.5);
+    result.p99_ns  = percentile(latencies, 0.99);
+    result.p999_ns = percentile(latencies, 0.999);
+    result.max_ns  = latencies.empty() ? 0 : latencies.back();
+
+    // the same operations once more on std::set
+    std::set<int> enemy_set;
+    generator_t generator(config, workload);
+    size_t query_idx = 0;
+    for (size_t done = 0; done < config.ops; done += chunk.size()) {
+        generator.fill(chunk, std::min(chunk_size, config.ops - done));
+        for (const auto& op : chunk) {
+            if (op.is_insert) {
+                enemy_set.insert(op.l_bound);
+                continue;
+            }
+            if (query_idx++ % config.check_every != 0)
+                continue;
+            size_t correct = (op.l_bound < op.u_bound) ?
+                             std::distance(enemy_set.lower_bound(op.l_bound),
+                                           enemy_set.upper_bound(op.u_bound)) : 0;
+            result.wrong += (answers[result.checked++] != correct);
+        }
+    }
+    return result;
+}
+
+void write_trace(const config_t& config, const std::string& workload) {
+    std::ofstream trace(config.write_trace);
+    if (!trace.is_open())
+        throw("Can not open trace file");
+    std::vector<op_t> chunk;
+    generator_t generator(config, workload);
+    for (size_t done = 0; done < config.ops; done += chunk.size()) {
+        generator.fill(chunk, std::min(chunk_size, config.ops - done));
+        for (const auto& op : chunk) {
+            if (op.is_insert)
+                trace << "k " << op.l_bound << '\n';
+            else
+                trace << "q " << op.l_bound << ' ' << op.u_bound << '\n';
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------------------
+
+// baseline file: one line "workload ops_per_sec p99_ns" per workload
+std::map<std::string, result_t> read_baseline(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open())
+        throw("Can not open baseline file");
+    std::map<std::string, result_t> baseline;
+    std::string workload;
+    result_t result;
+    while (file >> workload >> result.ops_per_sec >> result.p99_ns)
+        baseline[workload] = result;
+    return baseline;
+}
+
+config_t parse_args(int argc, char* argv[]) {
+    config_t config;
+    for (int idx = 1; idx + 1 < argc; idx += 2) {
+        std::string name  = argv[idx];
+        std::string value = argv[idx + 1];
+        if      (name == "--workload")      config.workload      = value;
+        else if (name == "--ops")           config.ops           = std::stoull(value);
+        else if (name == "--keys")          config.keys          = std::max<size_t>(2, std::stoull(value));
+        else if (name == "--width")         config.width         = std::stoull(value);
+        else if (name == "--seed")          config.seed          = unsigned(std::stoul(value));
+        else if (name == "--check-every")   config.check_every   = std::max<size_t>(1, std::stoull(value));
+        else if (name == "--sample-every")  config.sample_every  = std::max<size_t>(1, std::stoull(value));
+        else if (name == "--tolerance")     config.tolerance     = std::stod(value);
+        else if (name == "--baseline")      config.baseline      = value;
+        else if (name == "--save-baseline") config.save_baseline = value;
+        else if (name == "--write-trace")   config.write_trace   = value;
+        else if (name == "--ratio") {
+            size_t colon = value.find(':');
+            if (colon == std::string::npos)
+                throw("Ratio must look like inserts:queries");
+            config.inserts = std::stoull(value.substr(0, colon));
+            config.queries = std::stoull(value.substr(colon + 1));
+            if (config.inserts + config.queries == 0)
+                throw("Ratio must not be 0:0");
+        }
+        else
+            throw("Unknown option");
+    }
+    if (config.keys > size_t(std::numeric_limits<int>::max()) / 2 ||
+        config.width > size_t(std::numeric_limits<int>::max()) / 2)
+        throw("Key space and query width must fit in int");
+    return config;
+}
+
+int run_all(const config_t& config) {
+    std::vector<std::string> workloads = {"uniform", "zipf", "sorted", "hot", "adversarial"};
+    if (config.workload != "all") {
+        if (std::find(workloads.begin(), workloads.end(), config.workload) == workloads.end())
+            throw("Unknown workload");
+        workloads = {config.workload};
+    }
+
+    if (!config.write_trace.empty()) {
+        if (workloads.size() != 1)
+            throw("Trace is written for one workload");
+        write_trace(config, workloads.front());
+        return 0;
+    }
+
+    std::map<std::string, result_t> baseline;
+    if (!config.baseline.empty())
+        baseline = read_baseline(config.baseline);
+
+    std::cout << std::setw(14) << "workload";
+    bench::print_header({"ops", "ops/sec", "p50_ns", "p99_ns", "p999_ns", "max_ns",
+                         "peak_rss_mb", "rot/insert", "checked", "wrong"});
+    bool is_failed = false;
+    std::map<std::string, result_t> results;
+    for (const auto& workload : workloads) {
+        result_t result = run(config, workload);
+        results[workload] = result;
+        std::cout << std::setw(14) << workload;
+        bench::print_row(config.ops, {result.ops_per_sec, result.p50_ns, result.p99_ns,
+                                      result.p999_ns, result.max_ns, result.rss_mb,
+                                      result.rotations_per_insert, double(result.checked),
+                                      double(result.wrong)});
+        if (result.wrong != 0) {
+            std::cerr << workload << ": answers differ from std::set\n";
+            is_failed = true;
+        }
+
+        auto base = baseline.find(workload);
+        if (base == baseline.end())
+            continue;
+        if (result.ops_per_sec < base->second.ops_per_sec * (1 - config.tolerance) ||
+            result.p99_ns > base->second.p99_ns * (1 + config.tolerance)) {
+            std::cerr << workload << ": regression against baseline (ops/sec "
+                      << base->second.ops_per_sec << ", p99 " << base->second.p99_ns << " ns)\n";
+            is_failed = true;
+        }
+    }
+
+    if (!config.save_baseline.empty()) {
+        std::ofstream file(config.save_baseline);
+        for (const auto& [workload, result] : results)
+            file << workload << ' ' << result.ops_per_sec << ' ' << result.p99_ns << '\n';
+    }
+    return is_failed ? 1 : 0;
+}
+}
+
+//-----------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    try {
+        return run_all(parse_args(argc, argv));
+    }
+    catch (const char* error) {
+        std::cerr << error << '\n';
+        return 2;
+    }
+}
@@ -5,6 +5,7 @@
 #include "error_control.hpp"
 #include "logs.hpp"
 #include "time_control.hpp"
+#include "latency_histogram.hpp"
 #include "console_colors.hpp"
 
 //-----------------------------------------------------------------------------------------
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//-----------------------------------------------------------------------------------------
+
+namespace time_control {
+
+// HDR style histogram of latencies in nanoseconds: values are grouped by their power of
+// two and every power of two is split into 2^sub_bits linear buckets, so a percentile is
+// off by less than 1 / 2^sub_bits (3%) and recording is a few instructions.
+class latency_histogram_t final {
+    static constexpr unsigned sub_bits    = 5;
+    static constexpr size_t   sub_count   = size_t(1) << sub_bits;
+    static constexpr size_t   num_buckets = (64 - sub_bits + 1) * sub_count;
+
+    std::array<uint64_t, num_buckets> counts_ {};
+    uint64_t total_ = 0;
+    uint64_t max_   = 0;
+
+    public:
+        static size_t bucket(uint64_t value) {
+            if (value < sub_count)
+                return value;
+            unsigned shift = 63 - __builtin_clzll(value) - sub_bits;
+            return (shift + 1) * sub_count + (value >> shift) - sub_count;
+        }
+        // the largest value of a bucket
+        static uint64_t bucket_value(size_t bucket) {
+            if (bucket < sub_count)
+                return bucket;
+            unsigned shift = bucket / sub_count - 1;
+            uint64_t sub   = bucket % sub_count;
+            return ((sub_count + sub + 1) << shift) - 1;
+        }
+
+        void record(uint64_t value) {
+            ++counts_[bucket(value)];
+            ++total_;
+            max_ = std::max(max_, value);
+        }
+
+        void merge(const latency_histogram_t& hist) {
+            for (size_t idx = 0; idx < num_buckets; ++idx)
+                counts_[idx] += hist.counts_[idx];
+            total_ += hist.total_;
+            max_    = std::max(max_, hist.max_);
+        }
+
+        // value that share of recorded values do not exceed
+        uint64_t percentile(double share) const {
+            if (total_ == 0)
+                return 0;
+            uint64_t rank = std::max<uint64_t>(1, uint64_t(share * total_ + 0.5));
+            uint64_t seen = 0;
+            for (size_t idx = 0; idx < num_buckets; ++idx) {
+                seen += counts_[idx];
+                if (seen >= rank)
+                    return std::min(bucket_value(idx), max_);
+            }
+            return max_;
+        }
+
+        uint64_t count() const {return total_;};
+        uint64_t max()   const {return max_;};
+};
+
+//-----------------------------------------------------------------------------------------
+
+// Histograms of named operations. Every thread records into its own copy, so recording
+// takes no lock and shares no cache lines; copies are merged by merged() and report().
+class latency_recorder_t final {
+    using hists_t = std::vector<latency_histogram_t>;
+
+    std::vector<std::string> names_;
+    uint64_t id_;
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<hists_t>> threads_;
+
+    static uint64_t next_id() {
+        static std::atomic<uint64_t> id {0};
+        return ++id;
+    }
+
+    hists_t& local() {
+        // ids are never reused, so an entry of a destroyed recorder is never matched
+        thread_local std::vector<std::pair<uint64_t, hists_t*>> cache;
+        for (auto& [id, hists] : cache)
+            if (id == id_)
+                return *hists;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        threads_.push_back(std::make_unique<hists_t>(names_.size()));
+        cache.push_back({id_, threads_.back().get()});
+        return *threads_.back();
+    }
+
+    public:
+        explicit latency_recorder_t(std::vector<std::string> names) :
+            names_(std::move(names)), id_(next_id()) {};
+
+        void record(size_t op, uint64_t nanoseconds) {local()[op].record(nanoseconds);};
+
+        template<typename F>
+        decltype(auto) measure(size_t op, F&& func) {
+            struct timer_t {
+                latency_recorder_t* recorder;
+                size_t op;
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                ~timer_t() {
+                    auto time = std::chrono::steady_clock::now() - start;
+                    recorder->record(op, std::chrono::nanoseconds(time).count());
+                }
+            } timer {this, op};
+            return func();
+        }
+
+        std::vector<latency_histogram_t> merged() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::vector<latency_histogram_t> result(names_.size());
+            for (const auto& hists : threads_)
+                for (size_t op = 0; op < names_.size(); ++op)
+                    result[op].merge((*hists)[op]);
+            return result;
+        }
+
+        void report(std::ostream& strm) const {
+            std::vector<latency_histogram_t> hists = merged();
+            strm << std::setw(14) << "operation";
+            for (const char* col : {"count", "p50_ns", "p90_ns", "p99_ns", "p999_ns", "max_ns"})
+                strm << std::setw(12) << col;
+            strm << '\n';
+            for (size_t op = 0; op < names_.size(); ++op) {
+                const auto& hist = hists[op];
+                strm << std::setw(14) << names_[op] << std::setw(12) << hist.count();
+                for (double share : {0.5, 0.9, 0.99, 0.999})
+                    strm << std::setw(12) << hist.percentile(share);
+                strm << std::setw(12) << hist.max() << '\n';
+            }
+        }
+};
+
+}
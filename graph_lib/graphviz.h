@@ -25,6 +25,8 @@ struct node_t
 
     template<typename T>
     inline void print_node(const T* data_node, std::ofstream& graphviz_strm);
+    // attributes as graph defaults, so node lines need only a label
+    inline void print_defaults(std::ostream& graphviz_strm) const;
 };
 
 struct edge_t
@@ -39,6 +41,7 @@ struct edge_t
 
     template<typename T>
     inline void print_edge(const T* node_from, const T* node_to, std::ofstream& graphviz_strm);
+    inline void print_defaults(std::ostream& graphviz_strm) const;
 };
 
 struct dump_graph_t
@@ -12,6 +12,12 @@ void node_t::print_node (const T* data_node, std::ofstream& graphviz_strm) {
                << "| height: "          << data_node->height_  <<"}\"]\n";
 }
 
+void node_t::print_defaults(std::ostream& graphviz_strm) const {
+    graphviz_strm << "node [shape = \"" << shape << "\", fillcolor = \"" << fillcolor
+                  << "\", style = \"" << style << "\", fontcolor = \"" << fontcolor
+                  << "\", fontname = \"" << fontname << "\", color = \"" << color << "\"]\n";
+}
+
 //-----------------------------------------------------------------------------------------
 
 template<typename T>
@@ -24,5 +30,9 @@ void edge_t::print_edge (const T* node_from, const T* node_to, std::ofstream& gr
                << "\", fontname = \"" << fontname  << "\", label = \"" << label << "\"];\n";
 }
 
+void edge_t::print_defaults(std::ostream& graphviz_strm) const {
+    graphviz_strm << "edge [color = \"" << color << "\", fontname = \"" << fontname << "\"]\n";
+}
+
 //-----------------------------------------------------------------------------------------
 }
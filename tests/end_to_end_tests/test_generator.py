@@ -34,6 +34,8 @@ def generate_test_data(args):
             rand_list.append(val)
             continue
 
+    rand_list = order_keys(args, rand_list)
+
     res = 0
     my_list = list(my_set)
     for elem in my_list:
@@ -43,6 +45,22 @@ def generate_test_data(args):
     test_data = {res : rand_list}
     return test_data
 
+# keys are sorted in blocks of k for k-sorted order, so every key is at most k positions
+# away from its place in the sorted sequence
+
+def order_keys(args, keys):
+    if (args.order == "sorted"):
+        return sorted(keys)
+    if (args.order == "reverse"):
+        return sorted(keys, reverse = True)
+    if (args.order == "ksorted"):
+        keys = sorted(keys)
+        for i in range(0, len(keys), args.k):
+            block = keys[i : i + args.k]
+            random.shuffle(block)
+            keys[i : i + args.k] = block
+    return keys
+
 # -----------------------------------------------------------------------------------------
 
 def add_parse_arguments(parser):
@@ -51,9 +69,12 @@ def add_parse_arguments(parser):
     parser.add_argument('-f', '--file', type = str, default = os.path.dirname(os.path.abspath(__file__)) +
                                                               '/my_test_dat/gen_test.dat')
     parser.add_argument('-lub', nargs = 2, type = int, default = [0, 0])
+    parser.add_argument('-o', '--order', type = str, default = "random",
+                        choices = ["random", "sorted", "reverse", "ksorted"])
+    parser.add_argument('-k', type = int, default = 16)
 
 def check_args(args):
-    if (args.vd[0] >= args.vd[1] or args.lub[0] >= args.lub[1] or args.num > args.vd[1] - args.vd[0]):
+    if (args.vd[0] >= args.vd[1] or args.lub[0] >= args.lub[1] or args.num > args.vd[1] - args.vd[0] or args.k < 1):
         print("ERROR")
         exit()
 
@@ -0,0 +1,70 @@
+#pragma once
+
+using namespace avl;
+
+//-----------------------------------------------------------------------------------------
+
+template<typename balance_type>
+class balance_policy : public ::testing::Test {};
+
+using balance_types = ::testing::Types<balance::avl_t, balance::wavl_t, balance::weight_t>;
+TYPED_TEST_SUITE(balance_policy, balance_types);
+
+//-----------------------------------------------------------------------------------------
+
+TYPED_TEST(balance_policy, insert_and_erase) {
+    tree_t<int, false, TypeParam> tree;
+    std::set<int> enemy_set;
+    std::mt19937 gen(31);
+    std::uniform_int_distribution<int> dist(-3000, 3000);
+    for (int i = 0; i < 4000; ++i) {
+        int key = dist(gen);
+        tree.insert(key);
+        enemy_set.insert(key);
+    }
+    for (int key = 0; key < 1000; ++key)        // sorted tail
+        tree.insert(10000 + key);
+    for (int key = 0; key < 1000; ++key)
+        enemy_set.insert(10000 + key);
+    check_tree(tree);
+
+    for (int i = 0; i < 3000; ++i) {
+        int key = dist(gen);
+        ASSERT_TRUE(tree.erase(key) == enemy_set.erase(key));
+    }
+    check_tree(tree);
+    ASSERT_TRUE(tree.store_inorder_walk() == std::vector<int>(enemy_set.begin(), enemy_set.end()));
+
+    ASSERT_TRUE(tree.erase(-100, 100) == avl_tree_ui::range_query(enemy_set, -100, 100));
+    enemy_set.erase(enemy_set.lower_bound(-100), enemy_set.upper_bound(100));
+    check_tree(tree);
+    for (int l_bound = -3000; l_bound < 3000; l_bound += 97) {
+        ASSERT_TRUE(tree.range_query(l_bound, l_bound + 500) ==
+                    avl_tree_ui::range_query(enemy_set, l_bound, l_bound + 500));
+        ASSERT_TRUE(tree.rank(l_bound) ==
+                    size_t(std::distance(enemy_set.begin(), enemy_set.lower_bound(l_bound))));
+    }
+}
+
+TYPED_TEST(balance_policy, multiset_and_copy) {
+    multiset_t<int, TypeParam> tree;
+    std::multiset<int> enemy_set;
+    std::mt19937 gen(37);
+    std::uniform_int_distribution<int> dist(-200, 200);
+    for (int i = 0; i < 3000; ++i) {
+        int key = dist(gen);
+        tree.insert(key);
+        enemy_set.insert(key);
+    }
+    for (int i = 0; i < 100; ++i) {
+        int key = dist(gen);
+        ASSERT_TRUE(tree.erase(key) == enemy_set.erase(key));
+    }
+    check_tree(tree);
+
+    multiset_t<int, TypeParam> pine {tree};
+    pine.insert(1000);
+    check_tree(pine);
+    ASSERT_TRUE(pine.size() == enemy_set.size() + 1);
+    ASSERT_TRUE(tree.store_inorder_walk() == std::vector<int>(enemy_set.begin(), enemy_set.end()));
+}
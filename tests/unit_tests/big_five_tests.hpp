@@ -60,3 +60,54 @@ TEST_F(big_five, move_assignment_test) {
 
     ASSERT_TRUE(pine_storage == correct_tree);
 }
+
+TEST_F(big_five, copy_assignment_to_filled_tree) {
+    tree_t<int> pine;
+    pine.insert(1000);
+    pine.insert(-1000);
+    pine = tree;
+    std::vector<int> pine_storage = pine.store_inorder_walk();
+
+    ASSERT_TRUE(pine_storage == correct_tree);
+    ASSERT_TRUE(pine.range_query(0, 42) == tree.range_query(0, 42));
+    pine.insert(7);
+    ASSERT_TRUE(pine.range_query(0, 42) == tree.range_query(0, 42) + 1);
+}
+
+TEST_F(big_five, copy_empty_tree) {
+    tree_t<int> empty;
+    tree_t<int> pine {empty};
+    ASSERT_TRUE(pine.size() == 0);
+    tree = empty;
+    ASSERT_TRUE(tree.store_inorder_walk().empty());
+}
+
+TEST(big_five_clone, parallel_clone) {
+    tree_t<int> tree;
+    for (int key = 0; key < 200000; ++key)
+        tree.insert((key * 7919) % 200003);
+
+    auto copy = node_t<int>::clone(tree.get_root(), 4);
+    ASSERT_TRUE(copy->store_inorder_walk() == tree.store_inorder_walk());
+
+    tree_t<int> pine {tree};
+    for (int l_bound = 0; l_bound < 200003; l_bound += 9973)
+        ASSERT_TRUE(pine.range_query(l_bound, l_bound + 5000) ==
+                    tree.range_query(l_bound, l_bound + 5000));
+}
+
+TEST(big_five_pool, nodes_released_by_exited_threads) {
+    using pool_t = node_pool_t<node_t<int>>;
+    size_t num_of_slots = 0;
+    for (int round = 0; round < 10; ++round) {
+        auto tree = std::make_unique<tree_t<int>>();
+        for (int key = 0; key < 50000; ++key)
+            tree->insert(key);
+        std::thread destroyer {[&tree] { tree.reset(); }};
+        destroyer.join();
+
+        if (round == 0)
+            num_of_slots = pool_t::num_of_slots();
+        ASSERT_TRUE(pool_t::num_of_slots() == num_of_slots);
+    }
+}
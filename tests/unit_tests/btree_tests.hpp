@@ -0,0 +1,98 @@
+#pragma once
+
+using namespace avl;
+
+//-----------------------------------------------------------------------------------------
+
+template<typename key_type>
+void check_btree(const btree_t<key_type>& tree, const std::set<key_type>& enemy_set) {
+    ASSERT_TRUE(tree.size() == enemy_set.size());
+    std::vector<key_type> correct {enemy_set.begin(), enemy_set.end()};
+    ASSERT_TRUE(tree.store_inorder_walk() == correct);
+    for (size_t idx = 0; idx < correct.size(); idx += 7)
+        ASSERT_TRUE(*tree.select(idx) == correct[idx]);
+}
+
+//-----------------------------------------------------------------------------------------
+
+TEST(btree, random_and_sorted) {
+    std::mt19937 gen(3);
+    std::uniform_int_distribution<int> dist(-50'000, 50'000);
+
+    btree_t<int> tree;
+    std::set<int> enemy_set;
+    for (int i = 0; i < 30'000; ++i) {
+        int key = dist(gen);
+        ASSERT_TRUE(tree.insert(key) == enemy_set.insert(key).second);
+    }
+    check_btree(tree, enemy_set);
+
+    btree_t<int> sorted_tree;
+    std::set<int> sorted_set;
+    for (int key = 0; key < 30'000; ++key) {
+        sorted_tree.emplace(key);
+        sorted_set.insert(key);
+    }
+    check_btree(sorted_tree, sorted_set);
+    ASSERT_TRUE(sorted_tree.height() <= tree.height());
+}
+
+TEST(btree, queries) {
+    std::mt19937 gen(5);
+    std::uniform_int_distribution<int> dist(-10'000, 10'000);
+
+    btree_t<int> tree;
+    std::set<int> enemy_set;
+    for (int i = 0; i < 5'000; ++i) {
+        int key = dist(gen);
+        tree.insert(key);
+        enemy_set.insert(key);
+    }
+
+    for (int i = 0; i < 2'000; ++i) {
+        int l_bound = dist(gen);
+        int u_bound = dist(gen);
+        size_t correct = (l_bound <= u_bound) ?
+                         avl_tree_ui::range_query(enemy_set, l_bound, u_bound) : 0;
+        ASSERT_TRUE(tree.range_query(l_bound, u_bound) == ((l_bound < u_bound) ? correct : 0));
+        ASSERT_TRUE(tree.rank(l_bound) == size_t(std::distance(enemy_set.begin(),
+                                                               enemy_set.lower_bound(l_bound))));
+        ASSERT_TRUE(tree.count(l_bound) == enemy_set.count(l_bound));
+
+        auto lower = enemy_set.lower_bound(l_bound);
+        const int* found = tree.lower_bound(l_bound);
+        ASSERT_TRUE((lower == enemy_set.end()) ? found == nullptr : *found == *lower);
+
+        auto upper = enemy_set.upper_bound(l_bound);
+        found = tree.upper_bound(l_bound);
+        ASSERT_TRUE((upper == enemy_set.begin()) ? found == nullptr : *found == *std::prev(upper));
+
+        std::vector<int> walk;
+        tree.inorder_walk(l_bound, u_bound, [&](int key) {walk.push_back(key);});
+        ASSERT_TRUE(walk.size() == correct);
+    }
+    ASSERT_TRUE(tree.lower_bound(10'001) == nullptr);
+    ASSERT_TRUE(tree.upper_bound(-10'001) == nullptr);
+}
+
+TEST(btree, copy_and_strings) {
+    btree_t<std::string> tree;
+    std::set<std::string> enemy_set;
+    for (int i = 0; i < 3'000; ++i) {
+        std::string key = std::to_string(i * 7919 % 3001);
+        tree.insert(key);
+        enemy_set.insert(key);
+    }
+
+    btree_t<std::string> copy {tree};
+    tree.insert("new");
+    check_btree(copy, enemy_set);
+    enemy_set.insert("new");
+    check_btree(tree, enemy_set);
+
+    copy = tree;
+    btree_t<std::string> moved {std::move(tree)};
+    check_btree(copy, enemy_set);
+    check_btree(moved, enemy_set);
+    ASSERT_TRUE(tree.size() == 0 && tree.find("new") == nullptr);
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+using namespace avl;
+
+//-----------------------------------------------------------------------------------------
+
+inline buffer_config_t make_buffer_config(size_t max_buffer, bool merge_on_query = false) {
+    buffer_config_t config;
+    config.max_buffer     = max_buffer;
+    config.merge_on_query = merge_on_query;
+    return config;
+}
+
+template<bool is_multi, typename ref_type>
+void check_buffered(buffer_config_t config, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> dist(-2000, 2000);
+
+    buffered_tree_t<int, is_multi> tree {config};
+    ref_type ref;
+    for (int i = 0; i < 20000; ++i) {
+        int key = dist(gen);
+        tree.insert(key);
+        ref.insert(key);
+        if (i % 37 != 0)
+            continue;
+
+        int l_bound = dist(gen), u_bound = dist(gen);
+        size_t expected = (l_bound < u_bound) ?
+                          std::distance(ref.lower_bound(l_bound), ref.upper_bound(u_bound)) : 0;
+        ASSERT_TRUE(tree.range_query(l_bound, u_bound) == expected);
+        ASSERT_TRUE(tree.rank(key) == size_t(std::distance(ref.begin(), ref.lower_bound(key))));
+        ASSERT_TRUE(tree.size() == ref.size());
+
+        auto lower = ref.lower_bound(l_bound);
+        ASSERT_TRUE(*tree.lower_bound(l_bound) == (lower != ref.end() ? *lower : *ref.rbegin()));
+        auto upper = ref.upper_bound(u_bound);
+        ASSERT_TRUE(*tree.upper_bound(u_bound) ==
+                    (upper != ref.begin() ? *std::prev(upper) : *ref.begin()));
+    }
+    tree.merge();
+    ASSERT_TRUE(tree.buffered() == 0);
+    check_tree(tree.tree());
+    ASSERT_TRUE(tree.tree().store_inorder_walk() == std::vector<int>(ref.begin(), ref.end()));
+}
+
+TEST(buffered, set_with_exact_queries) {
+    check_buffered<false, std::set<int>>(make_buffer_config(1000), 1);
+    check_buffered<false, std::set<int>>(make_buffer_config(50), 2);
+}
+
+TEST(buffered, multiset_and_merge_on_query) {
+    check_buffered<true, std::multiset<int>>(make_buffer_config(700), 3);
+    check_buffered<true, std::multiset<int>>(make_buffer_config(1 << 20, true), 4);
+    check_buffered<false, std::set<int>>(make_buffer_config(300, true), 5);
+}
+
+TEST(buffered, empty) {
+    buffered_tree_t<int> tree;
+    ASSERT_FALSE(tree.lower_bound(1).has_value());
+    ASSERT_TRUE(tree.range_query(0, 10) == 0);
+    tree.insert(5);
+    ASSERT_TRUE(*tree.lower_bound(9) == 5);
+    ASSERT_TRUE(*tree.upper_bound(1) == 5);
+}
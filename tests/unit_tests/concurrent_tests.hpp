@@ -0,0 +1,76 @@
+#pragma once
+
+using namespace avl;
+
+//-----------------------------------------------------------------------------------------
+
+// Writers own the keys equal to their number modulo num_of_writers, so every answer of
+// the concurrent tree can be compared with a std::set shared under a mutex. Readers check
+// that what they see is one consistent tree.
+TEST(concurrent, same_as_locked_set) {
+    constexpr int num_of_writers = 4;
+    constexpr int num_of_ops     = 20000;
+
+    concurrent_tree_t<int> tree;
+    std::set<int> ref_set;
+    std::mutex    ref_lock;
+    std::atomic<size_t> num_of_mismatches = 0;
+    std::atomic<bool>   is_writing        = true;
+
+    std::vector<std::thread> threads;
+    for (int writer = 0; writer < num_of_writers; ++writer) {
+        threads.emplace_back([&, writer] {
+            std::mt19937 gen(writer);
+            std::uniform_int_distribution<int> dist(0, 500);
+            for (int i = 0; i < num_of_ops; ++i) {
+                int key = dist(gen) * num_of_writers + writer;
+                bool is_insert = gen() % 3 != 0;
+                size_t result = is_insert ? tree.insert(key) : tree.erase(key);
+
+                std::lock_guard<std::mutex> lock(ref_lock);
+                size_t expected = is_insert ? ref_set.insert(key).second : ref_set.erase(key);
+                if (result != expected)
+                    ++num_of_mismatches;
+            }
+        });
+    }
+    std::thread reader([&] {
+        while (is_writing) {
+            bool is_consistent = tree.read([](const tree_t<int>& snapshot) {
+                return snapshot.size() == 0 ||
+                       snapshot.range_query(std::numeric_limits<int>::min(),
+                                            std::numeric_limits<int>::max()) == snapshot.size();
+            });
+            if (!is_consistent)
+                ++num_of_mismatches;
+        }
+    });
+    for (auto& thread : threads)
+        thread.join();
+    is_writing = false;
+    reader.join();
+
+    ASSERT_TRUE(num_of_mismatches == 0);
+    tree.read([&](const tree_t<int>& snapshot) {
+        check_tree(snapshot);
+        ASSERT_TRUE(snapshot.store_inorder_walk() ==
+                    std::vector<int>(ref_set.begin(), ref_set.end()));
+    });
+    ASSERT_TRUE(tree.range_query(0, 1000) ==
+                ref_set.size() - std::distance(ref_set.upper_bound(1000), ref_set.end()));
+    ASSERT_TRUE(tree.lower_bound(-5) == *ref_set.begin());
+}
+
+TEST(concurrent, empty_tree) {
+    concurrent_tree_t<int> tree;
+    ASSERT_FALSE(tree.lower_bound(5).has_value());
+    ASSERT_FALSE(tree.upper_bound(5).has_value());
+    ASSERT_TRUE(tree.range_query(0, 10) == 0);
+    ASSERT_TRUE(tree.size() == 0);
+
+    tree.insert(7);
+    ASSERT_TRUE(*tree.lower_bound(5) == 7);
+    ASSERT_TRUE(*tree.upper_bound(5) == 7);
+    ASSERT_TRUE(tree.erase(7) == 1);
+    ASSERT_FALSE(tree.lower_bound(5).has_value());
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+using namespace avl;
+
+//-----------------------------------------------------------------------------------------
+
+size_t count_lines(const std::string& dump, const std::string& pattern) {
+    size_t num = 0;
+    for (size_t pos = dump.find(pattern); pos != std::string::npos;
+         pos = dump.find(pattern, pos + 1))
+        ++num;
+    return num;
+}
+
+//-----------------------------------------------------------------------------------------
+
+TEST(dump, full_and_limited) {
+    tree_t<int> tree;
+    for (int key = 0; key < 1000; ++key)
+        tree.insert(key);
+
+    std::ostringstream full;
+    tree.graphviz_dump(full);
+    ASSERT_TRUE(count_lines(full.str(), "{key: ") == 1000);
+    ASSERT_TRUE(count_lines(full.str(), " -> ") == 999);
+    ASSERT_TRUE(count_lines(full.str(), "subtree") == 0);
+
+    std::ostringstream limited;
+    dump_config_t<int> config;
+    config.max_depth = 2;
+    tree.graphviz_dump(limited, config);
+    ASSERT_TRUE(count_lines(limited.str(), "{key: ") == 7);
+    ASSERT_TRUE(count_lines(limited.str(), "subtree") == 8);
+}
+
+TEST(dump, range_and_sample) {
+    tree_t<int> tree;
+    for (int key = 0; key < 1000; ++key)
+        tree.insert(key);
+
+    std::ostringstream ranged;
+    dump_config_t<int> config;
+    config.l_bound = 100;
+    config.u_bound = 120;
+    tree.graphviz_dump(ranged, config);
+    std::string dump = ranged.str();
+    for (int key = 100; key <= 120; ++key)
+        ASSERT_TRUE(count_lines(dump, "{key: " + std::to_string(key) + "|") == 1);
+    ASSERT_TRUE(count_lines(dump, "{key: ") < 60);
+
+    std::ostringstream sampled;
+    config = {};
+    config.sample = 0.8;
+    tree.graphviz_dump(sampled, config);
+    size_t expanded  = count_lines(sampled.str(), "{key: ");
+    size_t collapsed = count_lines(sampled.str(), "subtree");
+    ASSERT_TRUE(expanded > 1 && expanded < 1000 && collapsed > 0);
+    ASSERT_TRUE(count_lines(sampled.str(), " -> ") == expanded + collapsed - 1);
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+using namespace avl;
+
+//-----------------------------------------------------------------------------------------
+
+class durable : public ::testing::Test {
+    protected:
+    std::string dir = "./durable_test_dir";
+    std::vector<int> correct_tree = {-14, 0, 3, 5, 11, 20, 21, 28, 42, 60};
+    std::array<int, 10> data = {5, 20, 21, -14, 0, 3, 42, 11, 60, 28};
+
+    journal_config_t config(size_t group_size, size_t checkpoint_every) {
+        journal_config_t config;
+        config.group_size       = group_size;
+        config.checkpoint_every = checkpoint_every;
+        return config;
+    }
+
+    void TearDown() {
+        std::remove((dir + "/journal.log").c_str());
+        std::remove((dir + "/checkpoint.dat").c_str());
+        std::remove(dir.c_str());
+    }
+};
+
+//-----------------------------------------------------------------------------------------
+
+TEST_F(durable, build_sorted) {
+    tree_t<int> tree = tree_t<int>::build_sorted(correct_tree);
+    ASSERT_TRUE(tree.store_inorder_walk() == correct_tree);
+    ASSERT_TRUE(tree.range_query(0, 42) == 8);
+    tree.insert(1);
+    ASSERT_TRUE(tree.range_query(0, 42) == 9);
+}
+
+TEST_F(durable, replay_journal) {
+    {
+        durable_tree_t<int> tree {dir, config(3, 0)};
+        for (const auto& key : data)
+            tree.insert(key);
+    }
+    durable_tree_t<int> tree {dir};
+    ASSERT_TRUE(tree.tree().store_inorder_walk() == correct_tree);
+}
+
+TEST_F(durable, checkpoint_and_tail) {
+    {
+        durable_tree_t<int> tree {dir, config(2, 4)};
+        for (const auto& key : data)
+            tree.emplace(key);
+    }
+    std::ifstream checkpoint {dir + "/checkpoint.dat"};
+    ASSERT_TRUE(checkpoint.good());
+
+    durable_tree_t<int> tree {dir};
+    ASSERT_TRUE(tree.tree().store_inorder_walk() == correct_tree);
+    ASSERT_TRUE(tree.range_query(0, 28) == 7);
+}
+
+TEST_F(durable, torn_tail) {
+    {
+        durable_tree_t<int> tree {dir, config(1024, 0)};
+        for (const auto& key : data)
+            tree.insert(key);
+    }
+    {
+        std::ofstream journal {dir + "/journal.log", std::ios::binary | std::ios::app};
+        journal << "torn_rec";
+    }
+    {
+        durable_tree_t<int> tree {dir};
+        ASSERT_TRUE(tree.tree().store_inorder_walk() == correct_tree);
+        tree.insert(100);
+    }
+    durable_tree_t<int> tree {dir};
+    ASSERT_TRUE(tree.tree().size() == correct_tree.size() + 1);
+}
+
+TEST_F(durable, crash_loses_only_uncommitted) {
+    for (bool is_committed : {false, true}) {
+        pid_t pid = ::fork();
+        ASSERT_TRUE(pid >= 0);
+        if (pid == 0) {
+            durable_tree_t<int> tree {dir, config(4, 0)};
+            for (const auto& key : data)
+                tree.insert(key);
+            if (is_committed)
+                tree.commit();
+            ::_exit(0);   // no destructor, as in a crash
+        }
+        int status = 0;
+        ::waitpid(pid, &status, 0);
+
+        {
+            durable_tree_t<int> tree {dir};
+            ASSERT_TRUE(tree.tree().size() == (is_committed ? data.size() : 8));
+        }
+        TearDown();
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+using namespace avl;
+
+//-----------------------------------------------------------------------------------------
+
+class erase : public ::testing::Test {
+    protected:
+    avl::tree_t<int> tree;
+    std::set<int> enemy_set;
+    void SetUp() {
+        std::mt19937 gen(17);
+        std::uniform_int_distribution<int> dist(-2000, 2000);
+        for (int i = 0; i < 3000; ++i) {
+            int key = dist(gen);
+            tree.insert(key);
+            enemy_set.insert(key);
+        }
+    }
+};
+
+//-----------------------------------------------------------------------------------------
+
+TEST_F(erase, erase_key) {
+    std::mt19937 gen(23);
+    std::uniform_int_distribution<int> dist(-2100, 2100);
+    for (int i = 0; i < 3000; ++i) {
+        int key = dist(gen);
+        ASSERT_TRUE(tree.erase(key) == enemy_set.erase(key));
+    }
+    check_tree(tree);
+    ASSERT_TRUE(tree.store_inorder_walk() == std::vector<int>(enemy_set.begin(), enemy_set.end()));
+    ASSERT_TRUE(tree.range_query(-500, 500) == avl_tree_ui::range_query(enemy_set, -500, 500));
+
+    for (int key : std::vector<int>(enemy_set.begin(), enemy_set.end()))
+        tree.erase(key);
+    ASSERT_TRUE(tree.size() == 0);
+    tree.insert(1);
+    ASSERT_TRUE(tree.store_inorder_walk() == std::vector<int>{1});
+}
+
+TEST_F(erase, erase_range) {
+    std::mt19937 gen(29);
+    std::uniform_int_distribution<int> dist(-2100, 2100);
+    for (int i = 0; i < 50; ++i) {
+        int l_bound = dist(gen);
+        int u_bound = l_bound + dist(gen) % 300;
+        size_t num = 0;
+        if (l_bound <= u_bound) {
+            num = avl_tree_ui::range_query(enemy_set, l_bound, u_bound);
+            enemy_set.erase(enemy_set.lower_bound(l_bound), enemy_set.upper_bound(u_bound));
+        }
+
+        ASSERT_TRUE(tree.erase(l_bound, u_bound) == num);
+        check_tree(tree);
+        tree.insert(l_bound);
+        enemy_set.insert(l_bound);
+    }
+    ASSERT_TRUE(tree.store_inorder_walk() == std::vector<int>(enemy_set.begin(), enemy_set.end()));
+    ASSERT_TRUE(tree.range_query(-500, 500) == avl_tree_ui::range_query(enemy_set, -500, 500));
+
+    ASSERT_TRUE(tree.erase(-10000, 10000) == enemy_set.size());
+    ASSERT_TRUE(tree.size() == 0);
+}
+
+TEST(erase_multiset, erase_all_copies) {
+    multiset_t<int> tree;
+    for (int key : {1, 2, 2, 2, 3, 4, 4})
+        tree.insert(key);
+    ASSERT_TRUE(tree.erase(2) == 3);
+    ASSERT_TRUE(tree.erase(2, 4) == 3);
+    ASSERT_TRUE(tree.store_inorder_walk() == std::vector<int>{1});
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+using namespace avl;
+
+//-----------------------------------------------------------------------------------------
+
+// keys in sorted order, every key is moved by less than k positions
+std::vector<int> k_sorted_keys(size_t num, size_t k, unsigned seed) {
+    std::vector<int> keys(num);
+    for (size_t i = 0; i < num; ++i)
+        keys[i] = static_cast<int>(i) * 3 - 5000;
+
+    std::mt19937 gen(seed);
+    for (size_t i = 0; i < num; i += k)
+        std::shuffle(keys.begin() + i, keys.begin() + std::min(num, i + k), gen);
+    return keys;
+}
+
+template<typename tree_type, typename set_type>
+void check_same(const tree_type& tree, const set_type& enemy_set) {
+    check_tree(tree);
+    ASSERT_TRUE(tree.size() == enemy_set.size());
+    ASSERT_TRUE(tree.store_inorder_walk() ==
+                std::vector<int>(enemy_set.begin(), enemy_set.end()));
+}
+
+//-----------------------------------------------------------------------------------------
+
+TEST(finger, sorted_and_reverse) {
+    tree_t<int> sorted_tree;
+    tree_t<int> reverse_tree;
+    std::set<int> enemy_set;
+    for (int key = 0; key < 5000; ++key) {
+        sorted_tree.insert(key);
+        reverse_tree.insert(-key);
+        enemy_set.insert(key);
+    }
+    check_same(sorted_tree, enemy_set);
+    ASSERT_TRUE(reverse_tree.range_query(-100, 0) == 101);
+    check_tree(reverse_tree);
+}
+
+TEST(finger, k_sorted) {
+    for (size_t k : {2, 16, 300}) {
+        tree_t<int> tree;
+        std::set<int> enemy_set;
+        for (int key : k_sorted_keys(4000, k, k)) {
+            tree.insert(key);
+            enemy_set.insert(key);
+        }
+        check_same(tree, enemy_set);
+    }
+}
+
+TEST(finger, random_with_duplicates) {
+    multiset_t<int> tree;
+    std::multiset<int> enemy_set;
+    std::mt19937 gen(5);
+    std::uniform_int_distribution<int> dist(-300, 300);
+    for (int i = 0; i < 4000; ++i) {
+        int key = dist(gen);
+        tree.insert(key);
+        enemy_set.insert(key);
+    }
+    check_same(tree, enemy_set);
+    ASSERT_TRUE(tree.count(7) == enemy_set.count(7));
+}
+
+TEST(finger, hint) {
+    tree_t<int> tree;
+    std::set<int> enemy_set;
+    std::mt19937 gen(9);
+    std::uniform_int_distribution<int> dist(-1000, 1000);
+    wrap_node_t<int> hint = tree.insert(wrap_node_t<int>(nullptr), 0);
+    enemy_set.insert(0);
+    for (int i = 0; i < 3000; ++i) {
+        int key = dist(gen);
+        wrap_node_t<int> node = tree.insert(hint, key);
+        enemy_set.insert(key);
+        ASSERT_TRUE(node.get_key() == key);
+        if (i % 7 == 0)
+            hint = tree.find(dist(gen) / 2);
+        if (!hint.is_valid())
+            hint = node;
+    }
+    check_same(tree, enemy_set);
+
+    tree.erase(-500, 500);
+    tree.insert(0);
+    enemy_set.erase(enemy_set.lower_bound(-500), enemy_set.upper_bound(500));
+    enemy_set.insert(0);
+    check_same(tree, enemy_set);
+}
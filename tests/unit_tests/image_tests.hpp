@@ -0,0 +1,127 @@
+#pragma once
+
+using namespace avl;
+
+//-----------------------------------------------------------------------------------------
+
+class image : public ::testing::Test {
+    protected:
+    avl::tree_t<int> tree;
+    const char* image_path = "./image_test.avlimg";
+    void SetUp() {
+        std::array<int, 20> data = {5, 20, 21, -14, 0, 3, 42, 11, 45, -100,
+                                    400, 68, 88, 60, 4, 5, 6, 7, 8, 28};
+        for (const auto& key : data) {
+            tree.insert(key);
+        }
+        avl::image::write(tree, image_path);
+    }
+    void TearDown() {
+        std::remove(image_path);
+    }
+};
+
+//-----------------------------------------------------------------------------------------
+
+TEST_F(image, inorder_walk) {
+    mapped_tree_t<int> mapped {image_path};
+    ASSERT_TRUE(mapped.verify_checksum());
+    ASSERT_TRUE(mapped.size() == tree.size());
+    ASSERT_TRUE(mapped.store_inorder_walk() == tree.store_inorder_walk());
+
+    std::vector<int> storage;
+    mapped.inorder_walk(5, 42, [&](int key) { storage.push_back(key); });
+    std::vector<int> correct = {5, 6, 7, 8, 11, 20, 21, 28, 42};
+    ASSERT_TRUE(storage == correct);
+}
+
+TEST_F(image, bounds) {
+    mapped_tree_t<int> mapped {image_path};
+    ASSERT_TRUE(*mapped.upper_bound(34) == 28);
+    ASSERT_TRUE(*mapped.upper_bound(800) == 400);
+    ASSERT_TRUE(*mapped.lower_bound(-1000000) == -100);
+    ASSERT_TRUE(*mapped.lower_bound(-15) == -14);
+    ASSERT_TRUE(mapped.lower_bound(401) == nullptr);
+    ASSERT_TRUE(mapped.upper_bound(-101) == nullptr);
+}
+
+TEST_F(image, range_query) {
+    mapped_tree_t<int> mapped {image_path};
+    for (int l_bound = -120; l_bound < 420; l_bound += 7) {
+        for (int u_bound = -120; u_bound < 420; u_bound += 11) {
+            ASSERT_TRUE(mapped.range_query(l_bound, u_bound) ==
+                        tree.range_query(l_bound, u_bound));
+        }
+    }
+}
+
+TEST_F(image, wrong_key_type) {
+    ASSERT_ANY_THROW(mapped_tree_t<double> {image_path});
+}
+
+TEST(image_empty, empty_tree) {
+    const char* path = "./image_empty_test.avlimg";
+    avl::tree_t<int> tree;
+    avl::image::write(tree, path);
+    mapped_tree_t<int> mapped {path};
+    ASSERT_TRUE(mapped.size() == 0);
+    ASSERT_TRUE(mapped.range_query(0, 10) == 0);
+    ASSERT_TRUE(mapped.lower_bound(0) == nullptr);
+    std::remove(path);
+}
+
+TEST_F(image, rewrite_keeps_mapped_image) {
+    mapped_tree_t<int> mapped {image_path};
+    std::vector<int> old_keys = tree.store_inorder_walk();
+
+    avl::tree_t<int> other;
+    for (int key = 0; key < 5; ++key)
+        other.insert(key);
+    avl::image::write(other, image_path);
+
+    ASSERT_TRUE(mapped.store_inorder_walk() == old_keys);
+    mapped_tree_t<int> remapped {image_path};
+    ASSERT_TRUE(remapped.store_inorder_walk() == other.store_inorder_walk());
+}
+
+TEST_F(image, corrupted_child_index) {
+    FILE* file = std::fopen(image_path, "r+b");
+    ASSERT_TRUE(file != nullptr);
+    uint32_t bad_idx = 1000;
+    size_t left_pos = sizeof(avl::image::header_t) + offsetof(avl::image::node_t<int>, left);
+    for (size_t idx = 0; idx < tree.size(); ++idx) {
+        std::fseek(file, long(left_pos + idx * sizeof(avl::image::node_t<int>)), SEEK_SET);
+        std::fwrite(&bad_idx, sizeof(bad_idx), 1, file);
+    }
+    std::fclose(file);
+    ASSERT_ANY_THROW((mapped_tree_t<int> {image_path, true}));
+    {
+        mapped_tree_t<int> mapped {image_path};
+        ASSERT_FALSE(mapped.verify_nodes());
+        ASSERT_ANY_THROW(mapped.lower_bound(-1000));
+    }
+
+    // a cycle of in-range indices
+    avl::image::write(tree, image_path);
+    file = std::fopen(image_path, "r+b");
+    uint32_t root_idx = 0;
+    std::fseek(file, long(offsetof(avl::image::header_t, root)), SEEK_SET);
+    ASSERT_TRUE(std::fread(&root_idx, sizeof(root_idx), 1, file) == 1);
+    size_t right_pos = sizeof(avl::image::header_t) + offsetof(avl::image::node_t<int>, right);
+    for (size_t idx = 0; idx < tree.size(); ++idx) {
+        std::fseek(file, long(right_pos + idx * sizeof(avl::image::node_t<int>)), SEEK_SET);
+        std::fwrite(&root_idx, sizeof(root_idx), 1, file);
+    }
+    std::fclose(file);
+    ASSERT_ANY_THROW((mapped_tree_t<int> {image_path, true}));
+    mapped_tree_t<int> mapped {image_path};
+    ASSERT_ANY_THROW(mapped.range_query(0, 1000));
+}
+
+TEST_F(image, open_without_node_check) {
+    mapped_tree_t<int> mapped {image_path};
+    mapped_tree_t<int> checked {image_path, true};
+    ASSERT_TRUE(mapped.verify_nodes());
+    ASSERT_TRUE(mapped.range_query(0, 42) == checked.range_query(0, 42));
+    ASSERT_TRUE(mapped.store_inorder_walk() == tree.store_inorder_walk());
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+using namespace avl;
+
+//-----------------------------------------------------------------------------------------
+
+namespace {
+
+// every node keeps the maximum high end of its subtree
+template<typename node_type>
+int check_max_high(const node_type* node) {
+    int max_high = node->get_key().high;
+    if (node->get_left())
+        max_high = std::max(max_high, check_max_high(node->get_left().get()));
+    if (node->get_right())
+        max_high = std::max(max_high, check_max_high(node->get_right().get()));
+    EXPECT_TRUE(node->get_augment() == max_high);
+    return max_high;
+}
+
+}
+
+TEST(interval, same_as_scan) {
+    std::mt19937 gen(44);
+    std::uniform_int_distribution<int> low_dist(0, 1000);
+    std::uniform_int_distribution<int> len_dist(0, 60);
+
+    interval_tree_t<int> tree;
+    std::vector<std::pair<int, int>> intervals;
+    for (int i = 0; i < 3000; ++i) {
+        if (!intervals.empty() && i % 3 == 2) {
+            size_t idx = gen() % intervals.size();
+            ASSERT_TRUE(tree.erase(intervals[idx].first, intervals[idx].second) == 1);
+            intervals.erase(intervals.begin() + idx);
+        }
+        else {
+            int low = low_dist(gen);
+            int high = low + len_dist(gen);
+            tree.insert(low, high);
+            intervals.push_back({low, high});
+        }
+    }
+    ASSERT_TRUE(tree.size() == intervals.size());
+    ASSERT_TRUE(tree.erase(2000, 2001) == 0);
+    check_max_high(tree.intervals().get_root());
+
+    for (int i = 0; i < 300; ++i) {
+        int l_bound = low_dist(gen);
+        int u_bound = l_bound + len_dist(gen) * (i % 2);
+        std::vector<std::pair<int, int>> expected;
+        for (auto [low, high] : intervals)
+            if (low <= u_bound && l_bound <= high)
+                expected.push_back({low, high});
+        std::sort(expected.begin(), expected.end());
+
+        std::vector<std::pair<int, int>> found;
+        for (auto& interval : tree.overlaps(l_bound, u_bound))
+            found.push_back({interval.low, interval.high});
+        ASSERT_TRUE(found == expected);
+        ASSERT_TRUE(tree.count_overlaps(l_bound, u_bound) == expected.size());
+    }
+}
+
+TEST(interval, stabbing) {
+    interval_tree_t<double, balance::wavl_t> tree;
+    tree.insert(1.0, 5.0);
+    tree.insert(2.0, 3.0);
+    tree.insert(2.0, 3.0);
+    tree.insert(4.0, 4.0);
+    tree.insert(6.0, std::numeric_limits<double>::infinity());
+
+    ASSERT_TRUE(tree.count_stabbing(0.5) == 0);
+    ASSERT_TRUE(tree.count_stabbing(2.5) == 3);
+    ASSERT_TRUE(tree.count_stabbing(4.0) == 2);
+    ASSERT_TRUE(tree.count_stabbing(1e100) == 1);
+    ASSERT_TRUE(tree.stabbing(3.0).size() == 3);
+    ASSERT_TRUE(tree.count_overlaps(5.5, 5.9) == 0);
+    ASSERT_TRUE(tree.count_overlaps(5.0, 6.0) == 2);
+    ASSERT_TRUE(tree.count_overlaps(6.0, 5.0) == 0);
+    ASSERT_THROW(tree.insert(3.0, 2.0), const char*);
+}
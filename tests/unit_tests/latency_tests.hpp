@@ -0,0 +1,47 @@
+#pragma once
+
+using namespace time_control;
+
+//-----------------------------------------------------------------------------------------
+
+TEST(latency, histogram_percentiles) {
+    latency_histogram_t hist;
+    for (uint64_t value = 1; value <= 100'000; ++value)
+        hist.record(value);
+
+    ASSERT_TRUE(hist.count() == 100'000 && hist.max() == 100'000);
+    for (double share : {0.5, 0.9, 0.99, 0.999}) {
+        double correct = share * 100'000;
+        double error   = std::abs(double(hist.percentile(share)) - correct) / correct;
+        ASSERT_TRUE(error < 1.0 / 32);
+    }
+    ASSERT_TRUE(hist.percentile(1.0) == 100'000);
+
+    for (uint64_t value : {0ull, 31ull, 32ull, 1000ull, 1ull << 40, ~0ull})
+        ASSERT_TRUE(latency_histogram_t::bucket_value(latency_histogram_t::bucket(value)) >= value);
+}
+
+TEST(latency, recorder_merges_threads) {
+    latency_recorder_t recorder {{"fast", "slow"}};
+    std::vector<std::thread> threads;
+    for (int idx = 0; idx < 4; ++idx)
+        threads.emplace_back([&] {
+            for (int op = 0; op < 1000; ++op) {
+                recorder.record(0, 10);
+                recorder.record(1, 1'000'000);
+            }
+        });
+    for (auto& thread : threads)
+        thread.join();
+    int answer = recorder.measure(0, [] {return 42;});
+
+    auto hists = recorder.merged();
+    ASSERT_TRUE(answer == 42);
+    ASSERT_TRUE(hists[0].count() == 4001 && hists[1].count() == 4000);
+    ASSERT_TRUE(hists[0].percentile(0.5) == 10);
+    ASSERT_TRUE(hists[1].max() == 1'000'000);
+
+    std::ostringstream report;
+    recorder.report(report);
+    ASSERT_TRUE(report.str().find("slow") != std::string::npos);
+}
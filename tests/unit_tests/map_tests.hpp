@@ -0,0 +1,65 @@
+#pragma once
+
+using namespace avl;
+
+//-----------------------------------------------------------------------------------------
+
+class map : public ::testing::Test {
+    protected:
+    avl::map_t<int, std::string> tree;
+    std::map<int, std::string> enemy_map;
+    void SetUp() {
+        std::array<int, 20> data = {5, 20, 21, -14, 0, 3, 42, 11, 45, -100,
+                                    400, 68, 88, 60, 4, 5, 6, 7, 8, 28};
+        for (const auto& key : data) {
+            tree.insert_or_assign(key, std::to_string(key * 2));
+            enemy_map.insert_or_assign(key, std::to_string(key * 2));
+        }
+    }
+};
+
+//-----------------------------------------------------------------------------------------
+
+TEST_F(map, find) {
+    ASSERT_TRUE(tree.size() == enemy_map.size());
+    for (const auto& [key, value] : enemy_map)
+        ASSERT_TRUE(*tree.find(key) == value);
+    ASSERT_TRUE(tree.find(1) == nullptr);
+}
+
+TEST_F(map, insert_or_assign) {
+    ASSERT_FALSE(tree.insert_or_assign(5, "five"));
+    ASSERT_TRUE(*tree.find(5) == "five");
+    ASSERT_TRUE(tree.insert_or_assign(1, "one"));
+    ASSERT_TRUE(*tree.find(1) == "one");
+    ASSERT_TRUE(tree.size() == enemy_map.size() + 1);
+}
+
+TEST_F(map, try_emplace) {
+    ASSERT_FALSE(tree.try_emplace(5, 3, 'x'));
+    ASSERT_TRUE(*tree.find(5) == "10");
+    ASSERT_TRUE(tree.try_emplace(2, 3, 'x'));
+    ASSERT_TRUE(*tree.find(2) == "xxx");
+}
+
+TEST_F(map, throwing_value) {
+    ASSERT_ANY_THROW(tree.try_emplace(2, size_t(-1), 'x'));
+    ASSERT_TRUE(tree.find(2) == nullptr);
+    ASSERT_TRUE(tree.size() == enemy_map.size());
+    ASSERT_TRUE(tree.try_emplace(2, 3, 'x'));
+    ASSERT_TRUE(*tree.find(2) == "xxx");
+    ASSERT_TRUE(*tree.find(5) == "10");
+}
+
+TEST_F(map, range) {
+    std::vector<std::pair<int, std::string>> storage;
+    tree.inorder_walk(0, 42, [&](int key, std::string& value) {
+        storage.push_back({key, value});
+        value += "!";
+    });
+    std::vector<std::pair<int, std::string>> correct {enemy_map.lower_bound(0),
+                                                      enemy_map.upper_bound(42)};
+    ASSERT_TRUE(storage == correct);
+    ASSERT_TRUE(*tree.find(42) == "84!");
+    ASSERT_TRUE(tree.range_query(0, 42) == correct.size());
+}
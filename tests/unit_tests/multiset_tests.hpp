@@ -0,0 +1,99 @@
+#pragma once
+
+using namespace avl;
+
+//-----------------------------------------------------------------------------------------
+
+class multiset : public ::testing::Test {
+    protected:
+    avl::multiset_t<int> tree;
+    std::multiset<int> enemy_set;
+    void SetUp() {
+        std::array<int, 20> data = {5, 20, 5, -14, 0, 3, 42, 5, 45, -100,
+                                    20, 68, 88, 60, 4, 5, 6, 7, 8, 20};
+        for (const auto& key : data) {
+            tree.insert(key);
+            enemy_set.insert(key);
+        }
+    }
+
+    size_t num_of_nodes(const node_t<int>* node) {
+        if (node == nullptr)
+            return 0;
+        return 1 + num_of_nodes(node->get_left().get()) + num_of_nodes(node->get_right().get());
+    }
+};
+
+//-----------------------------------------------------------------------------------------
+
+TEST_F(multiset, counts) {
+    ASSERT_TRUE(tree.size() == enemy_set.size());
+    ASSERT_TRUE(num_of_nodes(tree.get_root()) == std::set<int>(enemy_set.begin(),
+                                                               enemy_set.end()).size());
+    ASSERT_TRUE(tree.count(5)  == 4);
+    ASSERT_TRUE(tree.count(20) == 3);
+    ASSERT_TRUE(tree.count(21) == 0);
+
+    std::vector<int> storage {enemy_set.begin(), enemy_set.end()};
+    ASSERT_TRUE(tree.store_inorder_walk() == storage);
+}
+
+TEST_F(multiset, range_query) {
+    for (int l_bound = -120; l_bound < 100; l_bound += 3) {
+        for (int u_bound = l_bound + 1; u_bound < 100; u_bound += 5) {
+            ASSERT_TRUE(tree.range_query(l_bound, u_bound) ==
+                        avl_tree_ui::range_query(enemy_set, l_bound, u_bound));
+        }
+    }
+}
+
+TEST_F(multiset, rank_and_select) {
+    std::vector<int> storage {enemy_set.begin(), enemy_set.end()};
+    for (size_t idx = 0; idx < storage.size(); ++idx) {
+        ASSERT_TRUE(tree.select(idx).get_key() == storage[idx]);
+        ASSERT_TRUE(tree.rank(storage[idx]) ==
+                    size_t(std::distance(enemy_set.begin(), enemy_set.find(storage[idx]))));
+    }
+    ASSERT_FALSE(tree.select(storage.size()).is_valid());
+    ASSERT_TRUE(tree.rank(1000) == storage.size());
+}
+
+TEST_F(multiset, copy_and_build) {
+    multiset_t<int> pine {tree};
+    ASSERT_TRUE(pine.store_inorder_walk() == tree.store_inorder_walk());
+    ASSERT_TRUE(pine.range_query(0, 20) == tree.range_query(0, 20));
+
+    multiset_t<int> built = multiset_t<int>::build_sorted(tree.store_inorder_walk());
+    ASSERT_TRUE(built.store_inorder_walk() == tree.store_inorder_walk());
+    ASSERT_TRUE(built.count(5) == 4);
+    ASSERT_TRUE(built.range_query(5, 20) == tree.range_query(5, 20));
+}
+
+TEST_F(multiset, copy_of_many_copies) {
+    for (int key : {1, 2, 9, 10})
+        for (int copy = 0; copy < 200000; ++copy)
+            tree.insert(key);
+
+    using pool_t = node_pool_t<node_t<int>>;
+    size_t num_of_slots = pool_t::num_of_slots();
+    multiset_t<int> pine {tree};
+    ASSERT_TRUE(pool_t::num_of_slots() - num_of_slots == num_of_nodes(tree.get_root()));
+    ASSERT_TRUE(pine.size() == tree.size());
+    ASSERT_TRUE(pine.count(9) == 200000);
+    ASSERT_TRUE(pine.range_query(2, 4) == tree.range_query(2, 4));
+    ASSERT_TRUE(pine.store_inorder_walk() == tree.store_inorder_walk());
+}
+
+TEST(set_order_statistics, rank_and_select) {
+    tree_t<int> tree;
+    std::array<int, 10> data = {5, 20, 21, -14, 0, 3, 42, 11, 60, 28};
+    for (const auto& key : data)
+        tree.insert(key);
+    tree.insert(5);
+
+    ASSERT_TRUE(tree.size() == 10);
+    ASSERT_TRUE(tree.count(5) == 1);
+    ASSERT_TRUE(tree.rank(5) == 3);
+    ASSERT_TRUE(tree.select(3).get_key() == 5);
+    ASSERT_TRUE(tree.select(9).get_key() == 60);
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+using namespace avl;
+
+//-----------------------------------------------------------------------------------------
+
+// key that counts its constructions, compared with plain ints as well
+struct counted_key_t {
+    static inline size_t num_of_constructed = 0;
+    int key;
+
+    counted_key_t(int k) : key(k) {++num_of_constructed;};
+    counted_key_t(const counted_key_t& other) : key(other.key) {++num_of_constructed;};
+    counted_key_t(counted_key_t&& other) : key(other.key) {++num_of_constructed;};
+    counted_key_t& operator= (const counted_key_t& other) = default;
+
+    friend bool operator< (const counted_key_t& lhs, const counted_key_t& rhs) {return lhs.key < rhs.key;};
+    friend bool operator< (const counted_key_t& lhs, int rhs) {return lhs.key < rhs;};
+    friend bool operator< (int lhs, const counted_key_t& rhs) {return lhs < rhs.key;};
+    friend bool operator> (const counted_key_t& lhs, const counted_key_t& rhs) {return rhs.key < lhs.key;};
+    friend bool operator==(const counted_key_t& lhs, const counted_key_t& rhs) {return lhs.key == rhs.key;};
+};
+
+//-----------------------------------------------------------------------------------------
+
+TEST(node_handle, extract_and_insert) {
+    tree_t<int> tree;
+    tree_t<int> other;
+    std::set<int> enemy_set;
+    std::set<int> other_set;
+    for (int key = 0; key < 1000; ++key) {
+        tree.insert(key * 7 % 1000);
+        enemy_set.insert(key * 7 % 1000);
+    }
+
+    for (int key = 0; key < 1000; key += 3) {
+        const int* key_addr = &tree.find(key).get_key();
+        node_handle_t<int> node = tree.extract(key);
+        ASSERT_FALSE(node.empty());
+        ASSERT_TRUE(node.key() == key);
+        ASSERT_TRUE(other.insert(std::move(node)));
+        ASSERT_TRUE(node.empty());
+        ASSERT_TRUE(other.find(key).get_key() == key);
+        ASSERT_TRUE(&other.find(key).get_key() == key_addr); // the same node
+
+        enemy_set.erase(key);
+        other_set.insert(key);
+    }
+    ASSERT_TRUE(tree.extract(3).empty());
+    check_tree(tree);
+    check_tree(other);
+    ASSERT_TRUE(tree.store_inorder_walk() == std::vector<int>(enemy_set.begin(), enemy_set.end()));
+    ASSERT_TRUE(other.store_inorder_walk() == std::vector<int>(other_set.begin(), other_set.end()));
+}
+
+TEST(node_handle, change_key_and_duplicates) {
+    tree_t<int> tree;
+    for (int key : {1, 2, 3, 4, 5})
+        tree.insert(key);
+
+    node_handle_t<int> node = tree.extract(2);
+    node.key() = 4;
+    ASSERT_FALSE(tree.insert(std::move(node)));   // 4 is present, node stays in the handle
+    ASSERT_FALSE(node.empty());
+    node.key() = 10;
+    ASSERT_TRUE(tree.insert(std::move(node)));
+    ASSERT_TRUE(tree.store_inorder_walk() == (std::vector<int>{1, 3, 4, 5, 10}));
+    check_tree(tree);
+
+    multiset_t<int> multi_tree;
+    for (int key : {7, 7, 7, 8, 9})
+        multi_tree.insert(key);
+    node_handle_t<int> sevens = multi_tree.extract(7);
+    ASSERT_TRUE(sevens.count() == 3);
+    ASSERT_TRUE(multi_tree.size() == 2);
+    multi_tree.insert(7);
+    ASSERT_TRUE(multi_tree.insert(std::move(sevens)));
+    ASSERT_TRUE(multi_tree.count(7) == 4);
+    ASSERT_TRUE(multi_tree.size() == 6);
+    check_tree(multi_tree);
+}
+
+TEST(node_handle, try_emplace) {
+    tree_t<counted_key_t> tree;
+    for (int key = 0; key < 100; ++key)
+        tree.insert(counted_key_t(key));
+
+    counted_key_t::num_of_constructed = 0;
+    for (int key = 0; key < 100; ++key)
+        ASSERT_FALSE(tree.try_emplace(key));
+    ASSERT_TRUE(counted_key_t::num_of_constructed == 0);
+
+    ASSERT_TRUE(tree.try_emplace(100));
+    ASSERT_TRUE(tree.try_emplace(-5, -5));
+    ASSERT_TRUE(counted_key_t::num_of_constructed == 2);
+    ASSERT_TRUE(tree.size() == 102);
+    check_tree(tree);
+
+    tree_t<std::string> str_tree;
+    ASSERT_TRUE(str_tree.try_emplace("pine"));
+    ASSERT_TRUE(str_tree.try_emplace("aaa", 3, 'a'));
+    ASSERT_FALSE(str_tree.try_emplace("pine"));
+    ASSERT_TRUE(str_tree.store_inorder_walk() == (std::vector<std::string>{"aaa", "pine"}));
+
+    multiset_t<int> multi_tree;
+    ASSERT_TRUE(multi_tree.try_emplace(1));
+    ASSERT_TRUE(multi_tree.try_emplace(1));
+    ASSERT_TRUE(multi_tree.count(1) == 2);
+}
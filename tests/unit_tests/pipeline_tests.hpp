@@ -0,0 +1,57 @@
+#pragma once
+
+//-----------------------------------------------------------------------------------------
+
+template<typename F>
+std::string capture_output(F func) {
+    std::ostringstream out;
+    std::ostringstream log;
+    auto* old_out = std::cout.rdbuf(out.rdbuf());
+    auto* old_log = std::clog.rdbuf(log.rdbuf());
+    func();
+    std::cout.rdbuf(old_out);
+    std::clog.rdbuf(old_log);
+    return out.str();
+}
+
+//-----------------------------------------------------------------------------------------
+
+TEST(pipeline, ring_keeps_order) {
+    avl_tree_ui::spsc_ring_t<int, 8> ring;
+    std::vector<int> popped;
+    std::thread consumer([&] {
+        for (int idx = 0; idx < 10'000; ++idx)
+            popped.push_back(ring.pop());
+    });
+    for (int idx = 0; idx < 10'000; ++idx)
+        ring.push(int{idx});
+    consumer.join();
+
+    std::vector<int> correct(10'000);
+    std::iota(correct.begin(), correct.end(), 0);
+    ASSERT_TRUE(popped == correct);
+}
+
+TEST(pipeline, same_output_as_run_tree) {
+    std::mt19937 gen(8);
+    std::uniform_int_distribution<int> dist(-5'000, 5'000);
+    std::string input;
+    for (int idx = 0; idx < 20'000; ++idx) {
+        if (gen() % 2)
+            input += "k " + std::to_string(dist(gen)) + '\n';
+        else
+            input += "q " + std::to_string(dist(gen)) + ' ' + std::to_string(dist(gen)) + ' ';
+    }
+
+    for (const std::string& text : {input, std::string{}, std::string{"k 5 k 7 q 1 10 k"}}) {
+        std::istringstream serial_in {text};
+        std::istringstream pipelined_in {text};
+        std::string serial    = capture_output([&] {
+            avl_tree_ui::run_tree(serial_in);
+        });
+        std::string pipelined = capture_output([&] {
+            avl_tree_ui::run_tree_pipelined(pipelined_in);
+        });
+        ASSERT_TRUE(serial == pipelined);
+    }
+}
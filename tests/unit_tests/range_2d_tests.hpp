@@ -0,0 +1,38 @@
+#pragma once
+
+using namespace avl;
+
+//-----------------------------------------------------------------------------------------
+
+TEST(range_2d, same_as_scan) {
+    std::mt19937 gen(47);
+    std::uniform_int_distribution<int> dist(-100, 100);
+
+    for (size_t num : {0, 1, 2, 7, 1000}) {
+        std::vector<std::pair<int, int>> points(num);
+        for (auto& [x, y] : points) {
+            x = dist(gen);
+            y = dist(gen) / 4;       // many equal y
+        }
+        range_tree_2d_t<int, int> tree {points};
+        ASSERT_TRUE(tree.size() == num);
+
+        for (int i = 0; i < 500; ++i) {
+            int x_l = dist(gen), x_u = dist(gen), y_l = dist(gen) / 4, y_u = dist(gen) / 4;
+            size_t expected = std::count_if(points.begin(), points.end(), [&](auto& point) {
+                return x_l <= point.first && point.first <= x_u &&
+                       y_l <= point.second && point.second <= y_u;
+            });
+            ASSERT_TRUE(tree.count(x_l, x_u, y_l, y_u) == expected);
+        }
+    }
+}
+
+TEST(range_2d, bounds) {
+    range_tree_2d_t<double, int> tree {{{1.0, 5}, {1.0, 5}, {2.5, 7}, {3.0, -1}}};
+    ASSERT_TRUE(tree.count(1.0, 1.0, 5, 5) == 2);
+    ASSERT_TRUE(tree.count(0.0, 10.0, 0, 10) == 3);
+    ASSERT_TRUE(tree.count(2.0, 1.0, 0, 10) == 0);
+    ASSERT_TRUE(tree.count(0.0, 10.0, 8, 10) == 0);
+    ASSERT_TRUE(range_tree_2d_t<>{}.count(0, 1, 0, 1) == 0);
+}
@@ -35,3 +35,47 @@ TEST_F(range, lower_bound) {
     ASSERT_TRUE(node.get_key() == -14);
 }
 
+
+TEST_F(range, find) {
+    ASSERT_TRUE(tree.find(42).get_key() == 42);
+    ASSERT_FALSE(tree.find(43).is_valid());
+}
+
+TEST_F(range, inorder_walk) {
+    std::vector<int> storage;
+    tree.inorder_walk(4, 28, [&](int key) { storage.push_back(key); });
+    std::vector<int> correct = {4, 5, 6, 7, 8, 11, 20, 21, 28};
+    ASSERT_TRUE(storage == correct);
+}
+
+TEST(range_batch, same_as_single_queries) {
+    std::mt19937 gen(9);
+    std::uniform_int_distribution<int> dist(-20'000, 20'000);
+
+    multiset_t<int> tree;
+    for (int i = 0; i < 10'000; ++i)
+        tree.insert(dist(gen));
+
+    std::vector<int> keys;
+    std::vector<std::pair<int, int>> bounds;
+    for (int i = 0; i < 1'000; ++i) {
+        keys.push_back(dist(gen));
+        bounds.push_back({keys.back(), dist(gen)});
+    }
+    keys.push_back(-30'000);
+    keys.push_back(30'000);
+
+    auto lower  = tree.lower_bound_batch(keys);
+    auto upper  = tree.upper_bound_batch(keys);
+    auto ranges = tree.range_query_batch(bounds);
+    for (size_t idx = 0; idx < keys.size(); ++idx) {
+        ASSERT_TRUE(lower[idx].get_key() == tree.lower_bound(keys[idx]).get_key());
+        ASSERT_TRUE(upper[idx].get_key() == tree.upper_bound(keys[idx]).get_key());
+    }
+    for (size_t idx = 0; idx < bounds.size(); ++idx)
+        ASSERT_TRUE(ranges[idx] == tree.range_query(bounds[idx].first, bounds[idx].second));
+
+    tree_t<int> empty_tree;
+    ASSERT_FALSE(empty_tree.lower_bound_batch(keys).front().is_valid());
+    ASSERT_TRUE(empty_tree.range_query_batch(bounds).front() == 0);
+}
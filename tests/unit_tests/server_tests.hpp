@@ -0,0 +1,74 @@
+#pragma once
+
+//-----------------------------------------------------------------------------------------
+
+// sends the pieces one by one, closes the writing side and returns all answers
+std::string talk_to_server(const std::string& path, const std::vector<std::string>& pieces) {
+    sockaddr_un addr {};
+    addr.sun_family = AF_UNIX;
+    std::copy(path.begin(), path.end(), addr.sun_path);
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        return "no connection";
+    }
+
+    for (const auto& piece : pieces) {
+        if (::write(fd, piece.data(), piece.size()) != ssize_t(piece.size()))
+            break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    ::shutdown(fd, SHUT_WR);
+
+    std::string answers;
+    char buf[4096];
+    for (ssize_t num = 0; (num = ::read(fd, buf, sizeof(buf))) > 0;)
+        answers.append(buf, num);
+    ::close(fd);
+    return answers;
+}
+
+//-----------------------------------------------------------------------------------------
+
+TEST(server, pipelined_clients) {
+    std::string path = "/tmp/avl_unit_test_" + std::to_string(::getpid()) + ".sock";
+    avl_server::query_server_t server {path};
+    std::thread server_thread([&] {server.run();});
+
+    // commands are cut in the middle of numbers and between a query and its bounds
+    std::string first = talk_to_server(path, {"k 1 k 5 k 1", "0\nq 0 6\nq", " 4 11\nq 3 2",
+                                              "\nk -7 q -10 100 x q 1 1"});
+    std::string second;
+    std::thread client([&] {
+        std::vector<std::string> pieces;
+        for (int key = 100; key < 300; ++key)
+            pieces.push_back("k " + std::to_string(key) + " q 100 " + std::to_string(key) + "\n");
+        second = talk_to_server(path, pieces);
+    });
+    client.join();
+
+    server.stop();
+    server_thread.join();
+
+    ASSERT_TRUE(first == "2\n2\n0\n4\n0\n");
+    std::string correct;
+    for (int key = 100; key < 300; ++key)
+        correct += std::to_string(key == 100 ? 0 : key - 99) + "\n";
+    ASSERT_TRUE(second == correct);
+    ASSERT_TRUE(server.tree().size() == 204);
+}
+
+TEST(server, negative_number_split_after_sign) {
+    std::string path = "/tmp/avl_unit_test_sign_" + std::to_string(::getpid()) + ".sock";
+    avl_server::query_server_t server {path};
+    std::thread server_thread([&] {server.run();});
+
+    std::string answers = talk_to_server(path, {"k -", "5\nk 3\nq -", "6 4\nq -", "5 -5\n"});
+
+    server.stop();
+    server_thread.join();
+
+    ASSERT_TRUE(answers == "2\n0\n");
+    ASSERT_TRUE(server.tree().size() == 2);
+    ASSERT_TRUE(server.tree().find(-5).is_valid());
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+using namespace avl;
+
+//-----------------------------------------------------------------------------------------
+
+TEST(shared_image, publish_versions) {
+    const std::string name = "/avl_tree_test_" + std::to_string(::getpid());
+    shared_image_writer_t<int> writer {name, 1000};
+    shared_tree_t<int> reader {name};
+    ASSERT_TRUE(reader.size() == 0);
+    ASSERT_FALSE(reader.lower_bound(0).has_value());
+
+    tree_t<int> tree;
+    for (int key : {5, 20, 21, -14, 0, 3, 42, 11})
+        tree.insert(key);
+    writer.publish(tree);
+    ASSERT_TRUE(reader.size() == tree.size());
+    ASSERT_TRUE(reader.range_query(0, 20) == tree.range_query(0, 20));
+    ASSERT_TRUE(*reader.lower_bound(12) == 20);
+    ASSERT_TRUE(*reader.upper_bound(12) == 11);
+
+    tree.insert(100);
+    writer.publish(tree);
+    ASSERT_TRUE(reader.size() == 9);
+    ASSERT_TRUE(reader.generation() == writer.generation());
+    ASSERT_TRUE(reader.read([](const auto& view) {return view.verify_checksum();}));
+
+    pid_t child = ::fork();
+    ASSERT_TRUE(child >= 0);
+    if (child == 0) {
+        shared_tree_t<int> child_reader {name};
+        ::_exit(child_reader.range_query(-20, 200) == 9 ? 0 : 1);
+    }
+    int status = 0;
+    ::waitpid(child, &status, 0);
+    ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    for (int key = 0; key < 2000; ++key)
+        tree.insert(key);
+    ASSERT_THROW(writer.publish(tree), const char*);
+    ASSERT_THROW(shared_tree_t<double> {name}, const char*);
+    shared_image_writer_t<int>::unlink(name);
+}
+
+// every version i holds keys [0, 10 * i), a reader must always see one whole version
+TEST(shared_image, readers_see_whole_versions) {
+    const std::string name = "/avl_tree_test_versions_" + std::to_string(::getpid());
+    shared_image_writer_t<int> writer {name, 10000};
+    std::atomic<bool> is_publishing = true;
+    std::atomic<size_t> num_of_mismatches = 0;
+
+    std::thread reader_thread([&] {
+        shared_tree_t<int> reader {name};
+        while (is_publishing) {
+            reader.read([&](const auto& view) {
+                size_t size = view.size();
+                if (size % 10 != 0 || view.range_query(-1, 100000) != size ||
+                    (size > 0 && *view.upper_bound(100000) != int(size) - 1))
+                    ++num_of_mismatches;
+            });
+        }
+    });
+    tree_t<int> tree;
+    for (int version = 1; version <= 500; ++version) {
+        for (int key = 10 * (version - 1); key < 10 * version; ++key)
+            tree.insert(key);
+        writer.publish(tree);
+    }
+    is_publishing = false;
+    reader_thread.join();
+    shared_image_writer_t<int>::unlink(name);
+    ASSERT_TRUE(num_of_mismatches == 0);
+}
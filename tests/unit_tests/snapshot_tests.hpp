@@ -0,0 +1,54 @@
+#pragma once
+
+using namespace avl;
+
+//-----------------------------------------------------------------------------------------
+
+template<typename key_type, typename dist_type>
+void check_snapshot(size_t num, dist_type dist, unsigned seed) {
+    std::mt19937_64 gen(seed);
+    multiset_t<key_type> tree;
+    for (size_t i = 0; i < num; ++i)
+        tree.insert(static_cast<key_type>(dist(gen)));
+
+    compressed_snapshot_t<key_type> snapshot {tree};
+    std::vector<key_type> keys = tree.store_inorder_walk();
+    ASSERT_TRUE(snapshot.size() == keys.size());
+    ASSERT_TRUE(snapshot.store_inorder_walk() == keys);
+
+    for (int i = 0; i < 2000; ++i) {
+        key_type l_bound = static_cast<key_type>(dist(gen));
+        key_type u_bound = static_cast<key_type>(dist(gen));
+        ASSERT_TRUE(snapshot.range_query(l_bound, u_bound) == tree.range_query(l_bound, u_bound));
+        ASSERT_TRUE(snapshot.rank(l_bound) == tree.rank(l_bound));
+
+        auto lower = std::lower_bound(keys.begin(), keys.end(), l_bound);
+        ASSERT_TRUE(snapshot.lower_bound(l_bound).has_value() == (lower != keys.end()));
+        if (lower != keys.end()) {
+            ASSERT_TRUE(*snapshot.lower_bound(l_bound) == *lower);
+        }
+        auto upper = std::upper_bound(keys.begin(), keys.end(), u_bound);
+        ASSERT_TRUE(snapshot.upper_bound(u_bound).has_value() == (upper != keys.begin()));
+        if (upper != keys.begin()) {
+            ASSERT_TRUE(*snapshot.upper_bound(u_bound) == *std::prev(upper));
+        }
+    }
+}
+
+TEST(snapshot, same_as_tree) {
+    check_snapshot<int>(5000, std::uniform_int_distribution<int>(-3000, 3000), 1);
+    check_snapshot<int>(3000, std::uniform_int_distribution<int>(INT32_MIN, INT32_MAX), 2);
+    check_snapshot<int64_t>(3000, std::uniform_int_distribution<int64_t>(INT64_MIN, INT64_MAX), 3);
+    check_snapshot<uint16_t>(1000, std::uniform_int_distribution<int>(0, 65535), 4);
+    check_snapshot<int>(1, std::uniform_int_distribution<int>(7, 7), 5);
+}
+
+TEST(snapshot, compresses_dense_keys) {
+    std::vector<int> keys(100000);
+    std::iota(keys.begin(), keys.end(), -50000);
+    compressed_snapshot_t<int> snapshot {keys};
+    ASSERT_TRUE(snapshot.bytes() < keys.size());   // 7 bits per key and the top index
+    ASSERT_TRUE(snapshot.range_query(-10, 10) == 21);
+    ASSERT_TRUE(snapshot.select(12345) == 12345 - 50000);
+    ASSERT_TRUE(compressed_snapshot_t<int>{}.range_query(0, 1) == 0);
+}
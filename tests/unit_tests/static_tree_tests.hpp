@@ -0,0 +1,53 @@
+#pragma once
+
+using namespace avl;
+
+//-----------------------------------------------------------------------------------------
+
+namespace static_tree_checks {
+
+constexpr static_tree_t thresholds {std::array{500, 10, 100, 50, 10, 1000, 5}};
+
+static_assert(thresholds.size() == 6);
+static_assert(thresholds.contains(50) && !thresholds.contains(51));
+static_assert(thresholds.lower_bound(11)   == 50);
+static_assert(thresholds.lower_bound(50)   == 50);
+static_assert(thresholds.lower_bound(2000) == 1000);
+static_assert(thresholds.upper_bound(99)   == 50);
+static_assert(thresholds.upper_bound(100)  == 100);
+static_assert(thresholds.upper_bound(0)    == 5);
+static_assert(thresholds.rank(100) == 3);
+static_assert(thresholds.range_query(10, 500)  == 4);
+static_assert(thresholds.range_query(11, 99)   == 1);
+static_assert(thresholds.range_query(-10, 4)   == 0);
+static_assert(thresholds.range_query(500, 10)  == 0);
+static_assert(thresholds.range_query(0, 10000) == 6);
+
+constexpr static_tree_t<double, 1> single {std::array{1.5}};
+static_assert(single.lower_bound(0.0) == 1.5 && single.upper_bound(9.0) == 1.5);
+static_assert(single.range_query(1.0, 2.0) == 1);
+
+}
+
+//-----------------------------------------------------------------------------------------
+
+TEST(static_tree, same_as_tree) {
+    std::mt19937 gen(4);
+    std::uniform_int_distribution<int> dist(-300, 300);
+
+    std::array<int, 200> keys {};
+    for (auto& key : keys)
+        key = dist(gen);
+    static_tree_t static_tree {keys};
+    tree_t<int> tree;
+    for (int key : keys)
+        tree.insert(key);
+
+    ASSERT_TRUE(static_tree.size() == tree.size());
+    for (int key = -310; key <= 310; ++key) {
+        ASSERT_TRUE(static_tree.lower_bound(key) == tree.lower_bound(key).get_key());
+        ASSERT_TRUE(static_tree.upper_bound(key) == tree.upper_bound(key).get_key());
+        ASSERT_TRUE(static_tree.rank(key) == tree.rank(key));
+        ASSERT_TRUE(static_tree.range_query(key, key + 37) == tree.range_query(key, key + 37));
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+//-----------------------------------------------------------------------------------------
+
+// Walks the subtree and checks order of keys, parent links, size_ of every node and the
+// balance rule of the policy:
+//  avl_t    - height_ is the height and children heights differ by at most 1
+//  wavl_t   - height_ is a rank, rank differences are 1 or 2 and leaves have rank 1
+//  weight_t - the weight (size + 1) of a child is at most delta times the sibling one
+//             (not checked in multiset, where size counts copies of keys)
+// Returns height of the subtree.
+
+template<typename balance_type, bool is_multi, typename key_type>
+size_t check_subtree(const avl::node_t<key_type>* node, const avl::node_t<key_type>* parent) {
+    if (node == nullptr)
+        return 0;
+
+    const avl::node_t<key_type>* left  = node->get_left().get();
+    const avl::node_t<key_type>* right = node->get_right().get();
+    EXPECT_TRUE(node->get_parent() == parent);
+    if (left) {
+        EXPECT_TRUE(left->get_key() < node->get_key());
+    }
+    if (right) {
+        EXPECT_TRUE(node->get_key() < right->get_key());
+    }
+
+    size_t left_height  = check_subtree<balance_type, is_multi>(left, node);
+    size_t right_height = check_subtree<balance_type, is_multi>(right, node);
+    size_t left_size  = left  ? left->get_size()  : 0;
+    size_t right_size = right ? right->get_size() : 0;
+    EXPECT_TRUE(node->get_size() == node->get_count() + left_size + right_size);
+
+    size_t height = std::max(left_height, right_height) + 1;
+    if constexpr (std::is_same_v<balance_type, avl::balance::wavl_t>) {
+        size_t rank = node->get_height();
+        for (const auto* child : {left, right}) {
+            size_t child_rank = child ? child->get_height() : 0;
+            EXPECT_TRUE(rank > child_rank && rank - child_rank <= 2);
+        }
+        if (!left && !right) {
+            EXPECT_TRUE(rank == 1);
+        }
+    }
+    else if constexpr (std::is_same_v<balance_type, avl::balance::weight_t>) {
+        if (!is_multi) {
+            EXPECT_TRUE(avl::balance::weight_t::delta * (left_size + 1) >= right_size + 1);
+            EXPECT_TRUE(avl::balance::weight_t::delta * (right_size + 1) >= left_size + 1);
+        }
+        EXPECT_TRUE(node->get_height() == height);
+    }
+    else {
+        EXPECT_TRUE(left_height <= right_height + 1 && right_height <= left_height + 1);
+        EXPECT_TRUE(node->get_height() == height);
+    }
+    return height;
+}
+
+template<typename tree_type>
+void check_tree(const tree_type& tree) {
+    check_subtree<typename tree_type::balance_policy, tree_type::is_multiset>(
+                  tree.get_root(), decltype(tree.get_root()){nullptr});
+}
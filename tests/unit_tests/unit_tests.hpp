@@ -5,14 +5,61 @@
 #include <iostream>
 #include <array>
 #include <vector>
+#include <set>
+#include <map>
+#include <string>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <numeric>
+#include <deque>
+#include <algorithm>
+#include <sys/wait.h>
 #include <gtest/gtest.h>
 
 #include "graphviz.h"
 #include "avl_tree.hpp"
+#include "tree_image.hpp"
+#include "durable_tree.hpp"
+#include "avl_map.hpp"
+#include "static_tree.hpp"
+#include "window_tree.hpp"
+#include "interval_tree.hpp"
+#include "concurrent_tree.hpp"
+#include "buffered_tree.hpp"
+#include "range_tree_2d.hpp"
+#include "shared_tree.hpp"
+#include "compressed_snapshot.hpp"
+#include "query_server.hpp"
+#include "spsc_ring.hpp"
+#include "btree.hpp"
+#include "ui.hpp"
 #include "debug_utils.hpp"
 
+#include "tree_checker.hpp"
 #include "big_five_tests.hpp"
 #include "rotate_tests.hpp"
 #include "range_tests.hpp"
+#include "image_tests.hpp"
+#include "durable_tests.hpp"
+#include "multiset_tests.hpp"
+#include "map_tests.hpp"
+#include "erase_tests.hpp"
+#include "finger_tests.hpp"
+#include "node_handle_tests.hpp"
+#include "balance_tests.hpp"
+#include "btree_tests.hpp"
+#include "dump_tests.hpp"
+#include "static_tree_tests.hpp"
+#include "server_tests.hpp"
+#include "pipeline_tests.hpp"
+#include "latency_tests.hpp"
+#include "window_tests.hpp"
+#include "interval_tests.hpp"
+#include "concurrent_tests.hpp"
+#include "buffered_tests.hpp"
+#include "range_2d_tests.hpp"
+#include "shared_tests.hpp"
+#include "snapshot_tests.hpp"
 
 //-----------------------------------------------------------------------------------------
@@ -0,0 +1,66 @@
+#pragma once
+
+using namespace avl;
+
+//-----------------------------------------------------------------------------------------
+
+TEST(window, last_events) {
+    std::mt19937 gen(8);
+    std::uniform_int_distribution<int> dist(0, 200);
+
+    window_tree_t<int> window {500};
+    std::deque<int> last;
+    for (int i = 0; i < 20000; ++i) {
+        int key = dist(gen);
+        window.insert(key);
+        last.push_back(key);
+        if (last.size() > 500)
+            last.pop_front();
+
+        if (i % 97 == 0) {
+            int l_bound = dist(gen), u_bound = dist(gen);
+            size_t expected = std::count_if(last.begin(), last.end(), [&](int k) {
+                return l_bound <= k && k <= u_bound;
+            });
+            if (!(l_bound < u_bound))
+                expected = 0;
+            ASSERT_TRUE(window.range_query(l_bound, u_bound) == expected);
+        }
+    }
+    ASSERT_TRUE(window.size() == 500);
+    ASSERT_TRUE(window.keys().size() == 500);
+}
+
+TEST(window, expiry_by_age) {
+    using clock = std::chrono::steady_clock;
+    auto start = clock::time_point{};
+    auto at = [&](int ms) {return start + std::chrono::milliseconds(ms);};
+
+    window_tree_t<int> window {1000, std::chrono::milliseconds(10), 4};
+    for (int ms = 0; ms < 100; ++ms) {
+        window.insert(ms % 7, at(ms));
+        window.insert(ms % 7, at(ms));
+    }
+    // events of 89..99 ms are in the window at 99 ms
+    ASSERT_TRUE(window.range_query(0, 6, at(99)) == 22);
+    ASSERT_TRUE(window.range_query(0, 6, at(105)) == 10);
+    ASSERT_TRUE(window.range_query(0, 6, at(200)) == 0);
+    ASSERT_TRUE(window.size() == 0);
+
+    window.insert(5, at(200));
+    ASSERT_THROW(window.insert(5, at(150)), const char*);
+}
+
+TEST(window, erase_one) {
+    multiset_t<int, balance::wavl_t> tree;
+    for (int i = 0; i < 300; ++i)
+        tree.insert(i % 10);
+    for (int i = 0; i < 295; ++i)
+        ASSERT_TRUE(tree.erase_one(i % 10) == 1);
+    ASSERT_TRUE(tree.erase_one(0) == 0);
+    ASSERT_TRUE(tree.size() == 5);
+    ASSERT_TRUE(tree.range_query(0, 9) == 5);
+    ASSERT_TRUE(tree.count(4) == 0);
+    ASSERT_TRUE(tree.count(5) == 1);
+    ASSERT_TRUE(tree.count(9) == 1);
+}